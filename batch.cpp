@@ -0,0 +1,158 @@
+#include <vector>
+#include <string>
+#include <iostream>
+#include <iomanip>
+#include <map>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <chrono>
+#include <algorithm>
+#include "batch.h"
+using std::vector;
+using std::string;
+using namespace Sudoku;
+
+typedef std::chrono::steady_clock Clock;
+
+double Report::getRate() const noexcept
+{
+    return seconds > 0 ? puzzleCount / seconds : 0;
+}
+
+double Report::getLatency(const double percentile) const noexcept
+{
+    if (latencyVector.empty()) return 0;
+    TSize8 i = percentile / 100 * (latencyVector.size() - 1) + 0.5;
+    return latencyVector[i];
+}
+
+void Report::print(std::ostream& stream) const
+{
+    stream << "Puzzles: " << puzzleCount << " (" << solvedCount << " solved)\n";
+    stream << "Seconds: " << seconds << "\n";
+    stream << "Puzzles/s: " << (TSize8) getRate() << "\n";
+    stream << "Latency us:" << std::fixed << std::setprecision(1);
+    stream << " p50=" << getLatency(50) * 1e6;
+    stream << " p90=" << getLatency(90) * 1e6;
+    stream << " p99=" << getLatency(99) * 1e6;
+    stream << " p99.9=" << getLatency(99.9) * 1e6;
+    stream << " max=" << getLatency(100) * 1e6 << "\n";
+    stream << std::defaultfloat;
+}
+
+Batch::Batch(TSize size, unsigned int threadCount, bool learning, bool lanes, TSize4 chunkSize, double timeout)
+    : size(size), threadCount(std::max(threadCount, 1u)), learning(learning), lanes(lanes), 
+      chunkSize(std::max(chunkSize, 1u)), timeout(timeout) {}
+
+Report Batch::run(std::istream& input, std::ostream& output) const
+{
+    // Threads take chunks of lines in turn; finished chunks wait in
+    // outputMap until every earlier chunk has been written
+    std::mutex mutex;
+    std::condition_variable condition;
+    TSize8 inputIndex = 0;
+    bool inputEnd = false;
+    std::map<TSize8,vector<string>> outputMap;
+    TSize8 outputIndex = 0;
+    const TSize8 pendingLimit = 4 * threadCount;
+
+    Report report {0, 0, 0, {}};
+    vector<vector<double>> latencyVectors(threadCount);
+    vector<TSize8> solvedCounts(threadCount, 0);
+
+    // The links are built once and shared by the threads' copies;
+    // each puzzle resets the solver
+    Solver blank(size);
+    blank.setLearning(learning);
+    blank.setTimeout(timeout);
+    auto work = [&](const unsigned int threadID) {
+        Solver solver(blank);
+        vector<tuple<TSize2,TSize2,TSize2>> rcnums;
+        vector<string> lines;
+        vector<vector<tuple<TSize2,TSize2,TSize2>>> rcnumsVector;
+        vector<TSize4> laneIndexVector;
+        vector<string> laneLines;
+        while (true) {
+            TSize8 index;
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                condition.wait(lock, [&] { return inputEnd || inputIndex < outputIndex + pendingLimit; });
+                if (inputEnd) break;
+                lines.clear();
+                string line;
+                while (lines.size() < chunkSize && std::getline(input, line)) {
+                    if (!line.empty() && line.back() == '\r') line.pop_back();
+                    lines.push_back(std::move(line));
+                }
+                if (lines.size() < chunkSize) inputEnd = true;
+                if (lines.empty()) break;
+                index = inputIndex++;
+            }
+            // A slice of lines at a time on lanes, or else one by one
+            for (TSize4 first = 0; lanes && first < lines.size(); first += Lanes::LANE_COUNT) {
+                const Clock::time_point start = Clock::now();
+                const TSize4 last = std::min<TSize4>(first + Lanes::LANE_COUNT, lines.size());
+                // Malformed lines take no lane
+                rcnumsVector.resize(Lanes::LANE_COUNT);
+                laneIndexVector.clear();
+                for (TSize4 i = first; i < last; i++) {
+                    if (!solver.parse(lines[i], rcnumsVector[laneIndexVector.size()])) {
+                        lines[i].clear();
+                        continue;
+                    }
+                    laneIndexVector.push_back(i);
+                }
+                rcnumsVector.resize(laneIndexVector.size());
+                solvedCounts[threadID] += solver.solveLanes(rcnumsVector, laneLines);
+                for (TSize4 lane = 0; lane < laneIndexVector.size(); lane++)
+                    lines[laneIndexVector[lane]] = std::move(laneLines[lane]);
+                const double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+                latencyVectors[threadID].insert(latencyVectors[threadID].end(), last - first, seconds);
+            }
+            for (TSize4 i = 0; !lanes && i < lines.size(); i++) {
+                string& line = lines[i];
+                const Clock::time_point start = Clock::now();
+                const bool parsed = solver.parse(line, rcnums);
+                if (parsed && solver.solve(rcnums, true)) {
+                    line = solver.format();
+                    solvedCounts[threadID]++;
+                } else {
+                    line.clear();
+                }
+                if (parsed) solver.reset();
+                latencyVectors[threadID].push_back(std::chrono::duration<double>(Clock::now() - start).count());
+            }
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                outputMap[index] = std::move(lines);
+                for (auto iter = outputMap.begin(); iter != outputMap.end() && iter->first == outputIndex; ) {
+                    for (const string& line : iter->second) output << line << '\n';
+                    iter = outputMap.erase(iter);
+                    outputIndex++;
+                }
+            }
+            condition.notify_all();
+            lines = vector<string>();
+        }
+        condition.notify_all();
+    };
+
+    const Clock::time_point start = Clock::now();
+    vector<std::thread> threadVector;
+    threadVector.reserve(threadCount);
+    for (unsigned int threadID = 0; threadID < threadCount; threadID++)
+        threadVector.emplace_back(work, threadID);
+    for (std::thread& thread : threadVector) thread.join();
+    output.flush();
+    report.seconds = std::chrono::duration<double>(Clock::now() - start).count();
+
+    for (unsigned int threadID = 0; threadID < threadCount; threadID++) {
+        report.solvedCount += solvedCounts[threadID];
+        report.latencyVector.insert(report.latencyVector.end(),
+            latencyVectors[threadID].cbegin(), latencyVectors[threadID].cend());
+    }
+    report.puzzleCount = report.latencyVector.size();
+    std::sort(report.latencyVector.begin(), report.latencyVector.end());
+    return report;
+}
\ No newline at end of file
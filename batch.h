@@ -0,0 +1,45 @@
+#pragma once
+#include <vector>
+#include <string>
+#include <iostream>
+#include "sudoku.h"
+
+namespace Sudoku
+{
+    using std::vector;
+    using std::string;
+
+    struct Report
+    {
+        TSize8 puzzleCount;
+        TSize8 solvedCount;
+        double seconds;
+        vector<double> latencyVector;   // Seconds per puzzle, sorted
+
+        double getRate() const noexcept;
+        double getLatency(double percentile) const noexcept;
+        void print(std::ostream& stream) const;
+    };
+
+    // Streams puzzles in the line format of Solver::parse through a pool of
+    // threads and writes one line per input line, in input order: the solution,
+    // or an empty line for an unsolvable, malformed or empty one. With lanes,
+    // each thread solves its puzzles Lanes::LANE_COUNT at a time, see
+    // Solver::solveLanes, and a puzzle's latency is that of its whole slice. A
+    // timeout, if given, bounds each puzzle's search; one that runs out is
+    // written as an empty line too.
+    class Batch
+    {
+    private:
+        const TSize size;
+        const unsigned int threadCount;
+        const bool learning;
+        const bool lanes;
+        const TSize4 chunkSize;
+        const double timeout;
+    public:
+        Batch(TSize size, unsigned int threadCount, bool learning = false, bool lanes = true, 
+              TSize4 chunkSize = 256, double timeout = 0);
+        Report run(std::istream& input, std::ostream& output) const;
+    };
+};
\ No newline at end of file
@@ -0,0 +1,429 @@
+#include <iostream>
+#include <vector>
+#include <string>
+#include <tuple>
+#include <random>
+#include <chrono>
+#include <functional>
+#include <algorithm>
+#include <cstdlib>
+#include <sys/resource.h>
+#include "sudoku.h"
+using std::vector;
+using std::string;
+using std::tuple;
+using namespace Imply;
+using Sudoku::TSize;
+using Sudoku::TSize2;
+using Sudoku::TSize4;
+
+typedef std::chrono::steady_clock Clock;
+typedef vector<tuple<TSize2,TSize2,TSize2>> TRCNums;
+
+// Work done by one timed run of a workload
+struct Sample
+{
+    TCount runs;
+    TCount decisions;
+    TCount propagations;
+};
+
+// Setup builds the inputs untimed and returns the run that is timed
+struct Workload
+{
+    string name;
+    std::function<std::function<Sample()>()> setup;
+};
+
+// Well-known hard 9x9 puzzles: AI Escargot, Arto Inkala 2012, Easter Monster and two more
+static const vector<string> HARDEST = {
+    "1....7.9..3..2...8..96..5....53..9...1..8...26....4...3......1..4......7..7...3..",
+    "8..........36......7..9.2...5...7.......457.....1...3...1....68..85...1..9....4..",
+    "1.......2.9.4...5...6...7...5.9.3.......7.......85..4.7.....6...3...9.8...2.....1",
+    "..............3.85..1.2.......5.7.....4...1...9.......5......73..2.1........4...9",
+    "4.....8.5.3..........7......2.....6.....8.4......1.......6.3.7.5..2.....1.4......"
+};
+
+// Full grid: the pattern grid, shuffled by relabelling the numbers and permuting
+// the bands, the stacks and the rows and columns inside them
+static TRCNums makeGrid(TSize size, std::mt19937& rng)
+{
+    const TSize2 size2 = size * size;
+    auto permute = [&](TSize2 count, TSize2 blockSize) {
+        vector<TSize2> blocks(count / blockSize), lines(blockSize), order;
+        for (TSize2 k = 0; k < blocks.size(); k++) blocks[k] = k;
+        std::shuffle(blocks.begin(), blocks.end(), rng);
+        for (TSize2 block : blocks) {
+            for (TSize2 k = 0; k < blockSize; k++) lines[k] = block * blockSize + k;
+            std::shuffle(lines.begin(), lines.end(), rng);
+            order.insert(order.end(), lines.begin(), lines.end());
+        }
+        return order;
+    };
+    const vector<TSize2> rows = permute(size2, size), cols = permute(size2, size), nums = permute(size2, size2);
+    TRCNums grid;
+    for (TSize2 row = 0; row < size2; row++)
+        for (TSize2 col = 0; col < size2; col++)
+            grid.push_back({row, col, 1 + nums[(size * (rows[row] % size) + rows[row] / size + cols[col]) % size2]});
+    return grid;
+}
+
+// Puzzles from random grids: either a share of the cells kept at random, or cells
+// removed while the solution stays unique, which gives minimal and harder puzzles
+static vector<TRCNums> makePuzzles(TSize size, TSize4 count, double clueRatio, bool minimal, unsigned int seed)
+{
+    std::mt19937 rng(seed);
+    Sudoku::Solver solver(size);
+    vector<TRCNums> puzzles;
+    for (TSize4 i = 0; i < count; i++) {
+        TRCNums puzzle = makeGrid(size, rng);
+        std::shuffle(puzzle.begin(), puzzle.end(), rng);
+        if (!minimal) {
+            puzzle.resize(clueRatio * puzzle.size());
+        } else {
+            for (TSize4 k = puzzle.size(); k-- > 0; ) {
+                const tuple<TSize2,TSize2,TSize2> clue = puzzle[k];
+                puzzle.erase(puzzle.begin() + k);
+                const TCount solutionCount = solver.count(puzzle, 2);
+                solver.reset();
+                if (solutionCount != 1) puzzle.insert(puzzle.begin() + k, clue);
+            }
+        }
+        puzzles.push_back(puzzle);
+    }
+    return puzzles;
+}
+
+// Puzzles from random grids with cells removed while propagation alone still solves
+// them: the easy to medium puzzles of published collections
+static vector<TRCNums> makePropagatedPuzzles(TSize size, TSize4 count, unsigned int seed)
+{
+    std::mt19937 rng(seed);
+    Sudoku::Solver solver(size);
+    vector<TRCNums> puzzles;
+    for (TSize4 i = 0; i < count; i++) {
+        TRCNums puzzle = makeGrid(size, rng);
+        std::shuffle(puzzle.begin(), puzzle.end(), rng);
+        for (TSize4 k = puzzle.size(); k-- > 0; ) {
+            const tuple<TSize2,TSize2,TSize2> clue = puzzle[k];
+            puzzle.erase(puzzle.begin() + k);
+            solver.solve(puzzle);
+            if (solver.format().find('.') != string::npos) puzzle.insert(puzzle.begin() + k, clue);
+            solver.reset();
+        }
+        puzzles.push_back(puzzle);
+    }
+    return puzzles;
+}
+
+static vector<TRCNums> parsePuzzles(TSize size, const vector<string>& lines)
+{
+    Sudoku::Solver solver(size);
+    vector<TRCNums> puzzles;
+    for (const string& line : lines) {
+        TRCNums rcnums;
+        if (!solver.parse(line, rcnums)) {
+            std::cerr << "Bad puzzle " << line << "\n";
+            std::exit(1);
+        }
+        puzzles.push_back(rcnums);
+    }
+    return puzzles;
+}
+
+static Workload sudokuWorkload(const string& name, TSize size, std::function<vector<TRCNums>()> makeCorpus)
+{
+    return {name, [=]() {
+        auto solver = std::make_shared<Sudoku::Solver>(size);
+        auto rcnumsVector = std::make_shared<vector<TRCNums>>(makeCorpus());
+        return [=]() {
+            const TCount decisionCount = solver->getStatistics().decisionCount;
+            const TCount propagationCount = solver->getStatistics().propagationCount;
+            for (const TRCNums& rcnums : *rcnumsVector) {
+                if (!solver->solve(rcnums, true)) {
+                    std::cerr << name << ": unsolved puzzle\n";
+                    std::exit(1);
+                }
+                solver->reset();
+            }
+            return Sample {
+                rcnumsVector->size(),
+                solver->getStatistics().decisionCount - decisionCount,
+                solver->getStatistics().propagationCount - propagationCount};
+        };
+    }};
+}
+
+// The same as sudokuWorkload, Lanes::LANE_COUNT puzzles at a time; only puzzles left
+// open after propagation count decisions and propagations
+static Workload lanesWorkload(const string& name, TSize size, std::function<vector<TRCNums>()> makeCorpus)
+{
+    return {name, [=]() {
+        auto solver = std::make_shared<Sudoku::Solver>(size);
+        auto rcnumsVector = std::make_shared<vector<TRCNums>>(makeCorpus());
+        return [=]() {
+            const TCount decisionCount = solver->getStatistics().decisionCount;
+            const TCount propagationCount = solver->getStatistics().propagationCount;
+            vector<TRCNums> slice;
+            vector<string> lines;
+            for (TSize4 first = 0; first < rcnumsVector->size(); first += Lanes::LANE_COUNT) {
+                const TSize4 last = std::min<TSize4>(first + Lanes::LANE_COUNT, rcnumsVector->size());
+                slice.assign(rcnumsVector->begin() + first, rcnumsVector->begin() + last);
+                if (solver->solveLanes(slice, lines) != slice.size()) {
+                    std::cerr << name << ": unsolved puzzle\n";
+                    std::exit(1);
+                }
+            }
+            return Sample {
+                rcnumsVector->size(),
+                solver->getStatistics().decisionCount - decisionCount,
+                solver->getStatistics().propagationCount - propagationCount};
+        };
+    }};
+}
+
+// Pigeons into one fewer holes: each pigeon takes a hole, each hole takes at most one pigeon
+static vector<Link> makePigeonhole(TNodeID holeCount)
+{
+    const TNodeID pigeonCount = holeCount + 1;
+    vector<Link> links;
+    for (TNodeID pigeon = 0; pigeon < pigeonCount; pigeon++) {
+        vector<TNodeID> nodes;
+        for (TNodeID hole = 0; hole < holeCount; hole++) nodes.push_back(pigeon * holeCount + hole);
+        links.push_back(Link({}, {}, GE, 0, nodes, {}, GE, 1));
+    }
+    for (TNodeID hole = 0; hole < holeCount; hole++) {
+        vector<TNodeID> nodes;
+        for (TNodeID pigeon = 0; pigeon < pigeonCount; pigeon++) nodes.push_back(pigeon * holeCount + hole);
+        links.push_back(Link(AT_MOST_ONE, nodes));
+    }
+    return links;
+}
+
+static Workload pigeonholeWorkload(const string& name, TNodeID holeCount, bool learning)
+{
+    return {name, [=]() {
+        auto engine = std::make_shared<Engine>(makePigeonhole(holeCount), (holeCount + 1) * holeCount);
+        return [=]() {
+            // Fresh activities each run; rolling back forgets the links it learned
+            if (learning) {
+                engine->setHeuristic(ACTIVITY);
+                engine->setLearning(true);
+            }
+            const Engine::Checkpoint checkpoint = engine->checkpoint();
+            const TCount decisionCount = engine->getStatistics().decisionCount;
+            const TCount propagationCount = engine->getStatistics().propagationCount;
+            if (engine->backtrack()) {
+                std::cerr << name << ": solved\n";
+                std::exit(1);
+            }
+            engine->rollback(checkpoint);
+            return Sample {
+                1,
+                engine->getStatistics().decisionCount - decisionCount,
+                engine->getStatistics().propagationCount - propagationCount};
+        };
+    }};
+}
+
+// Random cardinality links: when a few nodes all hold their states, a count
+// bound holds over a few other nodes
+static vector<Link> makeRandom(TNodeID nodeSize, TLinkID linkSize, std::mt19937& rng)
+{
+    vector<TNodeID> nodeIDs(nodeSize);
+    for (TNodeID nodeID = 0; nodeID < nodeSize; nodeID++) nodeIDs[nodeID] = nodeID;
+    vector<Link> links;
+    for (TLinkID linkID = 0; linkID < linkSize; linkID++) {
+        std::shuffle(nodeIDs.begin(), nodeIDs.end(), rng);
+        const TNodeID inSize = 1 + rng() % 3, outSize = 2 + rng() % 4;
+        vector<TNodeID> trueIn, falseIn, trueOut, falseOut;
+        for (TNodeID i = 0; i < inSize; i++)
+            (rng() % 2 ? trueIn : falseIn).push_back(nodeIDs[i]);
+        for (TNodeID i = inSize; i < inSize + outSize; i++)
+            (rng() % 2 ? trueOut : falseOut).push_back(nodeIDs[i]);
+        const Equality outEquality = rng() % 2 ? GE : LE;
+        const TNodeID outLimit = 1 + rng() % (outSize - 1);
+        links.push_back(Link(trueIn, falseIn, GE, inSize, trueOut, falseOut, outEquality, outLimit));
+    }
+    return links;
+}
+
+static Workload randomWorkload(const string& name, TNodeID nodeSize, TLinkID linkSize, TSize4 count, unsigned int seed)
+{
+    return {name, [=]() {
+        std::mt19937 rng(seed);
+        auto engines = std::make_shared<vector<Engine>>();
+        for (TSize4 i = 0; i < count; i++) engines->emplace_back(makeRandom(nodeSize, linkSize, rng), nodeSize);
+        return [=]() {
+            Sample sample {0, 0, 0};
+            for (Engine& engine : *engines) {
+                const TCount decisionCount = engine.getStatistics().decisionCount;
+                const TCount propagationCount = engine.getStatistics().propagationCount;
+                engine.backtrack();
+                engine.reset();
+                sample.runs++;
+                sample.decisions += engine.getStatistics().decisionCount - decisionCount;
+                sample.propagations += engine.getStatistics().propagationCount - propagationCount;
+            }
+            return sample;
+        };
+    }};
+}
+
+// Random 3-SAT at the clause ratio where about half the instances have a solution
+// and search times are heavy-tailed, solved with learning and saved phases
+static vector<Link> makeThreeSAT(TNodeID nodeSize, std::mt19937& rng)
+{
+    vector<Link> links;
+    for (TLinkID linkID = 0; linkID < nodeSize * 426 / 100; linkID++) {
+        vector<TNodeID> nodeIDs;
+        while (nodeIDs.size() < 3) {
+            const TNodeID nodeID = rng() % nodeSize;
+            if (std::find(nodeIDs.begin(), nodeIDs.end(), nodeID) == nodeIDs.end()) nodeIDs.push_back(nodeID);
+        }
+        vector<TNodeID> trueOut, falseOut;
+        for (TNodeID nodeID : nodeIDs) (rng() % 2 ? trueOut : falseOut).push_back(nodeID);
+        links.push_back(Link({}, {}, GE, 0, trueOut, falseOut, GE, 1));
+    }
+    return links;
+}
+
+static Workload threeSATWorkload(const string& name, TNodeID nodeSize, TSize4 count, Restart restart, unsigned int seed)
+{
+    return {name, [=]() {
+        std::mt19937 rng(seed);
+        auto engines = std::make_shared<vector<Engine>>();
+        for (TSize4 i = 0; i < count; i++) engines->emplace_back(makeThreeSAT(nodeSize, rng), nodeSize);
+        return [=]() {
+            Sample sample {0, 0, 0};
+            for (Engine& engine : *engines) {
+                // Fresh activities and phases each run; rolling back forgets the links it learned
+                engine.setHeuristic(ACTIVITY, true);
+                engine.setLearning(true);
+                engine.setRestarts(restart);
+                const TCount decisionCount = engine.getStatistics().decisionCount;
+                const TCount propagationCount = engine.getStatistics().propagationCount;
+                engine.backtrack();
+                engine.reset();
+                sample.runs++;
+                sample.decisions += engine.getStatistics().decisionCount - decisionCount;
+                sample.propagations += engine.getStatistics().propagationCount - propagationCount;
+            }
+            return sample;
+        };
+    }};
+}
+
+// One constrain and rollback per node of the blank board
+static Workload microWorkload(const string& name, TSize size, TSize4 rounds)
+{
+    return {name, [=]() {
+        const TSize2 size2 = size * size;
+        const TNodeID nodeSize = size2 * size2 * size2;
+        auto engine = std::make_shared<Engine>(Sudoku::Solver(size).getLinks(), nodeSize);
+        auto nodeStatesVector = std::make_shared<vector<vector<pair<TNodeID,bool>>>>();
+        for (TNodeID nodeID = 0; nodeID < nodeSize; nodeID++) nodeStatesVector->push_back({{nodeID, true}});
+        return [=]() {
+            const TCount propagationCount = engine->getStatistics().propagationCount;
+            const Engine::Checkpoint checkpoint = engine->checkpoint();
+            for (TSize4 round = 0; round < rounds; round++) {
+                for (const vector<pair<TNodeID,bool>>& nodeStates : *nodeStatesVector) {
+                    engine->constrain(nodeStates);
+                    engine->rollback(checkpoint);
+                }
+            }
+            return Sample {TCount(rounds) * nodeSize, 0, engine->getStatistics().propagationCount - propagationCount};
+        };
+    }};
+}
+
+// Builds the solver of an empty board, from its groups or, as before them, from its links
+static Workload buildWorkload(const string& name, TSize size, bool links, TSize4 count)
+{
+    return {name, [=]() {
+        return [=]() {
+            const TSize2 size2 = size * size;
+            for (TSize4 i = 0; i < count; i++) {
+                if (!links) {
+                    Sudoku::Solver solver(size);
+                    continue;
+                }
+                // An empty engine only to call getLinks on
+                Sudoku::Solver solver(size, AnyEngine());
+                Sudoku::Solver(size, makeEngine(solver.getLinks(), TNodeID(size2) * size2 * size2));
+            }
+            return Sample {count, 0, 0};
+        };
+    }};
+}
+
+static long getPeakRSS()
+{
+    // Kilobytes on Linux
+    rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    return usage.ru_maxrss;
+}
+
+// Usage: bench [filter] [repeats]
+//   Runs the workloads whose names contain filter and prints one tab-separated
+//   row each. Inputs come from fixed seeds, so rows of two builds can be diffed.
+//   Seconds is the median of the repeats. Peak RSS is the process peak so far;
+//   pass a single workload as filter to measure it alone. Propagations are only
+//   counted in a build with IMPLY_STATISTICS, and read 0 otherwise.
+int main(int argc, char** argv)
+{
+    const string filter = argc > 1 ? argv[1] : "";
+    const unsigned int repeatCount = std::max(argc > 2 ? std::atoi(argv[2]) : 5, 1);
+
+    const vector<Workload> workloads = {
+        sudokuWorkload("sudoku3-easy", 3, [] { return makePuzzles(3, 2000, 0.45, false, 1); }),
+        sudokuWorkload("sudoku3-minimal", 3, [] { return makePuzzles(3, 200, 0, true, 2); }),
+        sudokuWorkload("sudoku3-hardest", 3, [] {
+            vector<TRCNums> puzzles;
+            for (TSize4 pass = 0; pass < 20; pass++) {
+                const vector<TRCNums> hardest = parsePuzzles(3, HARDEST);
+                puzzles.insert(puzzles.end(), hardest.begin(), hardest.end());
+            }
+            return puzzles;
+        }),
+        sudokuWorkload("sudoku3-propagated", 3, [] { return makePropagatedPuzzles(3, 2000, 7); }),
+        lanesWorkload("sudoku3-propagated-lanes", 3, [] { return makePropagatedPuzzles(3, 2000, 7); }),
+        lanesWorkload("sudoku3-minimal-lanes", 3, [] { return makePuzzles(3, 200, 0, true, 2); }),
+        sudokuWorkload("sudoku4", 4, [] { return makePuzzles(4, 100, 0.45, false, 3); }),
+        sudokuWorkload("sudoku5", 5, [] { return makePuzzles(5, 100, 0.55, false, 4); }),
+        sudokuWorkload("sudoku6", 6, [] { return makePuzzles(6, 20, 0.6, false, 6); }),
+        pigeonholeWorkload("pigeonhole8", 8, false),
+        pigeonholeWorkload("pigeonhole8-learn", 8, true),
+        randomWorkload("random-cardinality", 60, 150, 100, 5),
+        threeSATWorkload("random-3sat", 150, 50, NEVER, 5),
+        threeSATWorkload("random-3sat-luby", 150, 50, LUBY, 5),
+        threeSATWorkload("random-3sat-geometric", 150, 50, GEOMETRIC, 5),
+        microWorkload("micro-constrain-rollback3", 3, 20),
+        microWorkload("micro-constrain-rollback5", 5, 1),
+        buildWorkload("build-sudoku5", 5, false, 20),
+        buildWorkload("build-sudoku5-links", 5, true, 20),
+        buildWorkload("build-sudoku6", 6, false, 20),
+        buildWorkload("build-sudoku6-links", 6, true, 20)
+    };
+
+    std::cout << "workload\truns\tseconds\tns/propagation\tdecisions/s\tpropagations\tdecisions\tpeak_rss_kb\n";
+    for (const Workload& workload : workloads) {
+        if (workload.name.find(filter) == string::npos) continue;
+        const std::function<Sample()> run = workload.setup();
+        Sample sample {0, 0, 0};
+        vector<double> secondsVector;
+        for (unsigned int repeat = 0; repeat < repeatCount; repeat++) {
+            const Clock::time_point start = Clock::now();
+            sample = run();
+            secondsVector.push_back(std::chrono::duration<double>(Clock::now() - start).count());
+        }
+        std::sort(secondsVector.begin(), secondsVector.end());
+        const double seconds = secondsVector[secondsVector.size() / 2];
+        std::cout << workload.name << "\t" << sample.runs << "\t" << seconds << "\t"
+            << (sample.propagations > 0 ? seconds * 1e9 / sample.propagations : 0) << "\t"
+            << (seconds > 0 ? sample.decisions / seconds : 0) << "\t"
+            << sample.propagations << "\t" << sample.decisions << "\t" << getPeakRSS() << std::endl;
+    }
+    return 0;
+}
\ No newline at end of file
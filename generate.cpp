@@ -0,0 +1,204 @@
+#include <vector>
+#include <tuple>
+#include <string>
+#include <iostream>
+#include <iomanip>
+#include <random>
+#include <map>
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <chrono>
+#include <algorithm>
+#include <type_traits>
+#include "generate.h"
+using std::vector;
+using std::tuple;
+using std::string;
+using namespace Sudoku;
+
+typedef std::chrono::steady_clock Clock;
+
+// Branching for the grid and the uniqueness checks; on 16x16 boards ORDER and
+// SLACK take up to tens of seconds a grid where this takes under one
+static const Heuristic CHECK_HEURISTIC = ACTIVITY;
+
+double GenerateReport::getRate() const noexcept
+{
+    return seconds > 0 ? gridCount / seconds : 0;
+}
+
+TCount GenerateReport::getDecisions(const double percentile) const noexcept
+{
+    if (decisionVector.empty()) return 0;
+    TSize8 i = percentile / 100 * (decisionVector.size() - 1) + 0.5;
+    return decisionVector[i];
+}
+
+void GenerateReport::print(std::ostream& stream) const
+{
+    stream << "Grids: " << gridCount << " (" << discardCount << " over budget)\n";
+    stream << "Puzzles: " << puzzleCount << " written, " << missCount << " missed\n";
+    stream << "Seconds: " << seconds << "\n";
+    stream << "Grids/s: " << std::fixed << std::setprecision(1) << getRate() << std::defaultfloat << "\n";
+    stream << "Decisions:";
+    stream << " p50=" << getDecisions(50);
+    stream << " p90=" << getDecisions(90);
+    stream << " p99=" << getDecisions(99);
+    stream << " max=" << getDecisions(100) << "\n";
+}
+
+Generator::Generator(TSize size, unsigned int threadCount, TCount minDecisions, TCount maxDecisions, unsigned int seed,
+                     TSize8 attemptLimit, TCount checkBudget)
+    : size(size), threadCount(std::max(threadCount, 1u)),
+      minDecisions(minDecisions), maxDecisions(maxDecisions), seed(seed),
+      attemptLimit(std::max<TSize8>(attemptLimit, 1)), checkBudget(checkBudget) {}
+
+GenerateReport Generator::run(const TSize8 count, std::ostream& output) const
+{
+    // Threads take puzzle indices in turn; finished puzzles wait in outputMap
+    // until every earlier one has been written
+    std::mutex mutex;
+    std::atomic<TSize8> nextIndex(0);
+    std::map<TSize8,string> outputMap;
+    TSize8 outputIndex = 0;
+
+    GenerateReport report {0, 0, 0, 0, 0, {}};
+    vector<vector<TCount>> decisionVectors(threadCount);
+    vector<TSize8> gridCounts(threadCount, 0);
+    vector<TSize8> discardCounts(threadCount, 0);
+
+    // The links are built once and shared by the threads' copies
+    const Solver blank(size);
+    auto work = [&](const unsigned int threadID) {
+        Solver solver(blank);
+        vector<tuple<TSize2,TSize2,TSize2>> puzzle;
+        for (TSize8 index; (index = nextIndex++) < count; ) {
+            std::seed_seq seedSeq {seed, (unsigned int) (index >> 32), (unsigned int) index};
+            std::mt19937 rng(seedSeq);
+            bool found = false;
+            for (TSize8 attempt = 0; attempt < attemptLimit && !found; attempt++) {
+                TCount decisionCount;
+                gridCounts[threadID]++;
+                if (!generate(solver, rng, puzzle, decisionCount)) {
+                    discardCounts[threadID]++;
+                    continue;
+                }
+                found = decisionCount >= minDecisions && decisionCount <= maxDecisions;
+                if (found) decisionVectors[threadID].push_back(decisionCount);
+            }
+            // A missed puzzle holds its place with an empty line, which is not written
+            string line = found ? solver.format(puzzle) : string();
+
+            std::lock_guard<std::mutex> lock(mutex);
+            outputMap[index] = std::move(line);
+            for (auto iter = outputMap.begin(); iter != outputMap.end() && iter->first == outputIndex; ) {
+                if (!iter->second.empty()) output << iter->second << '\n';
+                iter = outputMap.erase(iter);
+                outputIndex++;
+            }
+        }
+    };
+
+    const Clock::time_point start = Clock::now();
+    vector<std::thread> threadVector;
+    threadVector.reserve(threadCount);
+    for (unsigned int threadID = 0; threadID < threadCount; threadID++)
+        threadVector.emplace_back(work, threadID);
+    for (std::thread& thread : threadVector) thread.join();
+    output.flush();
+    report.seconds = std::chrono::duration<double>(Clock::now() - start).count();
+
+    for (unsigned int threadID = 0; threadID < threadCount; threadID++) {
+        report.gridCount += gridCounts[threadID];
+        report.discardCount += discardCounts[threadID];
+        report.decisionVector.insert(report.decisionVector.end(),
+            decisionVectors[threadID].cbegin(), decisionVectors[threadID].cend());
+    }
+    report.puzzleCount = report.decisionVector.size();
+    report.missCount = count - report.puzzleCount;
+    std::sort(report.decisionVector.begin(), report.decisionVector.end());
+    return report;
+}
+
+bool Generator::generate(Solver& solver, std::mt19937& rng, vector<tuple<TSize2,TSize2,TSize2>>& puzzle, 
+                         TCount& decisionCount) const
+{
+    const TSize2 size2 = size * size;
+    const TSize4 cellCount = (TSize4) size2 * size2;
+    return std::visit([&](auto& engine) {
+        typedef std::decay_t<decltype(engine)> TEngine;
+        typedef typename TEngine::NodeID TNodeID;
+        vector<TNodeID> trueNodeIDs;
+        // Searches that run past the budget give up the grid
+        Limits limits;
+        limits.decisionBudget = checkBudget;
+        engine.setHeuristic(CHECK_HEURISTIC);
+
+        // Grid: the diagonal boxes, which share no row, column or box, at random,
+        // then the first solution of the rest
+        vector<TSize2> nums(size2);
+        for (TSize2 num = 0; num < size2; num++) nums[num] = num;
+        for (TSize box = 0; box < size; box++) {
+            std::shuffle(nums.begin(), nums.end(), rng);
+            for (TSize2 k = 0; k < size2; k++)
+                trueNodeIDs.push_back(solver.index(box * size + k / size, box * size + k % size, nums[k]));
+        }
+        engine.constrain(trueNodeIDs, {});
+        if (engine.solve(limits) != SAT) {
+            engine.reset();
+            return false;
+        }
+        vector<TNodeID> gridNodeIDs(cellCount);
+        for (TSize4 cell = 0; cell < cellCount; cell++)
+            for (TSize2 num = 0; num < size2; num++)
+                if (engine.getNodeState(cell * size2 + num) == TRUE) gridNodeIDs[cell] = cell * size2 + num;
+        engine.reset();
+
+        // Checkpoint k holds the givens of the cells after k in the order
+        vector<TSize4> cells(cellCount);
+        for (TSize4 cell = 0; cell < cellCount; cell++) cells[cell] = cell;
+        std::shuffle(cells.begin(), cells.end(), rng);
+        vector<typename TEngine::Checkpoint> checkpoints(cellCount);
+        checkpoints[cellCount - 1] = engine.checkpoint();
+        for (TSize4 k = cellCount - 1; k > 0; k--) {
+            const TNodeID nodeID = gridNodeIDs[cells[k]];
+            if (engine.getNodeState(nodeID) == MAYBE) engine.constrain({nodeID}, {});
+            checkpoints[k - 1] = engine.checkpoint();
+        }
+        vector<TNodeID> keptNodeIDs;
+        for (TSize4 k = 0; k < cellCount; k++) {
+            engine.rollback(checkpoints[k]);
+            trueNodeIDs.clear();
+            for (TNodeID nodeID : keptNodeIDs)
+                if (engine.getNodeState(nodeID) == MAYBE) trueNodeIDs.push_back(nodeID);
+            engine.constrain(trueNodeIDs, {});
+            // Removable if the other givens fix the cell, or leave it no other number in any solution
+            const TNodeID nodeID = gridNodeIDs[cells[k]];
+            if (engine.getNodeState(nodeID) == TRUE || !engine.constrain({}, {nodeID})) continue;
+            const Result result = engine.solve(limits);
+            if (result == UNKNOWN) {
+                engine.reset();
+                return false;
+            }
+            if (result == SAT) keptNodeIDs.push_back(nodeID);
+        }
+        engine.reset();
+
+        // Difficulty: decisions to solve the puzzle from its givens alone, by the
+        // solver's own order; past maxDecisions it is too hard whatever the count
+        std::sort(keptNodeIDs.begin(), keptNodeIDs.end());
+        puzzle.clear();
+        for (TNodeID nodeID : keptNodeIDs)
+            puzzle.push_back({nodeID / size2 / size2, nodeID / size2 % size2, nodeID % size2 + 1});
+        engine.setHeuristic(ORDER);
+        Limits solveLimits;
+        solveLimits.decisionBudget = maxDecisions + 1;
+        const TCount startCount = engine.getStatistics().decisionCount;
+        engine.constrain(keptNodeIDs, {});
+        engine.solve(solveLimits);
+        decisionCount = engine.getStatistics().decisionCount - startCount;
+        engine.reset();
+        return true;
+    }, solver.engine);
+}
\ No newline at end of file
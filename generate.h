@@ -0,0 +1,59 @@
+#pragma once
+#include <vector>
+#include <tuple>
+#include <random>
+#include <iostream>
+#include "sudoku.h"
+
+namespace Sudoku
+{
+    using std::vector;
+    using std::tuple;
+
+    struct GenerateReport
+    {
+        TSize8 gridCount;       // Grids tried
+        TSize8 discardCount;    // Of those, given up when a search ran past the budget
+        TSize8 puzzleCount;     // Puzzles of the target difficulty, written
+        TSize8 missCount;       // Puzzles not written, none found in the attempts allowed
+        double seconds;
+        vector<TCount> decisionVector;  // Decisions to solve each written puzzle, sorted
+
+        double getRate() const noexcept;    // Grids per second
+        TCount getDecisions(double percentile) const noexcept;
+        void print(std::ostream& stream) const;
+    };
+
+    // Makes minimal puzzles: a random full grid, then each cell in random order
+    // removed unless the grid would no longer be unique. Each thread checks on one
+    // engine: the cells still to try are constrained once, with a checkpoint per
+    // cell, and every check rolls back to the checkpoint of the cells after it and
+    // adds only the cells kept so far. A cell stays if a search still finds a
+    // solution with it holding another number; a grid whose search takes more than
+    // checkBudget decisions is given up, zero for no budget. A puzzle's difficulty
+    // is the decisions the solver takes to solve it; ones outside the target are
+    // made again from a new grid, up to attemptLimit grids, and a puzzle with none
+    // in target is counted as missed and not written. Puzzle i comes from seed and
+    // i alone, so the output, in the line format of Solver::parse, is the same for
+    // any thread count.
+    class Generator
+    {
+    private:
+        const TSize size;
+        const unsigned int threadCount;
+        const TCount minDecisions, maxDecisions;
+        const unsigned int seed;
+        const TSize8 attemptLimit;
+        const TCount checkBudget;
+    public:
+        Generator(TSize size, unsigned int threadCount,
+                  TCount minDecisions = 0, TCount maxDecisions = ~TCount(0), unsigned int seed = 1,
+                  TSize8 attemptLimit = 1000, TCount checkBudget = 10000);
+        GenerateReport run(TSize8 count, std::ostream& output) const;
+        // One minimal puzzle on the solver, which must have no givens and is left
+        // without them, and the decisions it takes to solve, counted up to just
+        // past maxDecisions; false if the grid was given up
+        bool generate(Solver& solver, std::mt19937& rng, vector<tuple<TSize2,TSize2,TSize2>>& puzzle, 
+                      TCount& decisionCount) const;
+    };
+};
\ No newline at end of file
@@ -0,0 +1,128 @@
+#pragma once
+#include <vector>
+#include <functional>
+
+namespace Imply
+{
+    using std::vector;
+
+    // Indexed binary heap over the IDs [0, size), ordered by a key per ID.
+    // Push, pop and key updates are O(log n); an ID keeps its key while out of the heap.
+    template<typename TID, typename TKey, typename TCompare = std::less<TKey>>
+    class Heap
+    {
+    private:
+        static constexpr TID NONE = ~TID(0);
+        vector<TKey> keyVector;
+        vector<TID> heapVector;
+        vector<TID> indexVector;
+    public:
+        Heap() noexcept {}
+        Heap(TID size, TKey key);
+
+        bool empty() const noexcept { return heapVector.empty(); }
+        TID size() const noexcept { return heapVector.size(); }
+        bool contains(TID id) const noexcept { return indexVector[id] != NONE; }
+        TID top() const noexcept { return heapVector.front(); }
+        const TKey& getKey(TID id) const noexcept { return keyVector[id]; }
+
+        void grow(TID size, TKey key);
+        void push(TID id);
+        TID pop() noexcept;
+        void update(TID id, TKey key) noexcept;
+        void scale(TKey factor) noexcept;
+    private:
+        void siftUp(TID index) noexcept;
+        void siftDown(TID index) noexcept;
+    };
+
+    template<typename TID, typename TKey, typename TCompare>
+    Heap<TID,TKey,TCompare>::Heap(TID size, TKey key)
+        : keyVector(size, key), heapVector(), indexVector(size, NONE)
+    {
+        heapVector.reserve(size);
+    }
+
+    template<typename TID, typename TKey, typename TCompare>
+    void Heap<TID,TKey,TCompare>::grow(TID size, TKey key)
+    {
+        // New IDs up to size start out of the heap
+        if (size <= keyVector.size()) return;
+        keyVector.resize(size, key);
+        indexVector.resize(size, NONE);
+    }
+
+    template<typename TID, typename TKey, typename TCompare>
+    void Heap<TID,TKey,TCompare>::push(TID id)
+    {
+        if (contains(id)) return;
+        indexVector[id] = heapVector.size();
+        heapVector.push_back(id);
+        siftUp(indexVector[id]);
+    }
+
+    template<typename TID, typename TKey, typename TCompare>
+    TID Heap<TID,TKey,TCompare>::pop() noexcept
+    {
+        TID id = heapVector.front();
+        indexVector[id] = NONE;
+        TID last = heapVector.back();
+        heapVector.pop_back();
+        if (!heapVector.empty()) {
+            heapVector.front() = last;
+            indexVector[last] = 0;
+            siftDown(0);
+        }
+        return id;
+    }
+
+    template<typename TID, typename TKey, typename TCompare>
+    void Heap<TID,TKey,TCompare>::update(TID id, TKey key) noexcept
+    {
+        TKey oldKey = keyVector[id];
+        keyVector[id] = key;
+        if (!contains(id)) return;
+        if (TCompare()(key, oldKey)) siftUp(indexVector[id]);
+        else                         siftDown(indexVector[id]);
+    }
+
+    template<typename TID, typename TKey, typename TCompare>
+    void Heap<TID,TKey,TCompare>::scale(TKey factor) noexcept
+    {
+        // Uniform scaling by a positive factor keeps the heap order
+        for (TKey& key : keyVector) key *= factor;
+    }
+
+    template<typename TID, typename TKey, typename TCompare>
+    void Heap<TID,TKey,TCompare>::siftUp(TID index) noexcept
+    {
+        TID id = heapVector[index];
+        while (index > 0) {
+            TID parent = (index - 1) / 2;
+            if (!TCompare()(keyVector[id], keyVector[heapVector[parent]])) break;
+            heapVector[index] = heapVector[parent];
+            indexVector[heapVector[index]] = index;
+            index = parent;
+        }
+        heapVector[index] = id;
+        indexVector[id] = index;
+    }
+
+    template<typename TID, typename TKey, typename TCompare>
+    void Heap<TID,TKey,TCompare>::siftDown(TID index) noexcept
+    {
+        TID id = heapVector[index];
+        TID size = heapVector.size();
+        while (true) {
+            TID child = 2 * index + 1;
+            if (child >= size) break;
+            if (child + 1 < size && TCompare()(keyVector[heapVector[child + 1]], keyVector[heapVector[child]])) child++;
+            if (!TCompare()(keyVector[heapVector[child]], keyVector[id])) break;
+            heapVector[index] = heapVector[child];
+            indexVector[heapVector[index]] = index;
+            index = child;
+        }
+        heapVector[index] = id;
+        indexVector[id] = index;
+    }
+};
\ No newline at end of file
@@ -1,80 +1,172 @@
 #include <vector>
 #include <memory>
 #include <cassert>
+#include <algorithm>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <cmath>
+#if defined(__AVX2__)
+#include <immintrin.h>
+#endif
 #include "imply.h"
 using std::vector;
 using std::pair;
 using namespace Imply;
 
-Node::Node(const Node& other)
-    : state(other.state),
-      trueInLen(other.trueInLen), trueOutLen(other.trueOutLen),
-      falseInLen(other.falseInLen), falseOutLen(other.falseOutLen)
-{
-    TLinkID trueLen = trueInLen + trueOutLen;
-    TLinkID falseLen = falseInLen + falseOutLen;
-    trueArray = std::make_unique<TLinkID[]>(trueLen);
-    falseArray = std::make_unique<TLinkID[]>(falseLen);
-    std::copy(other.trueArray.get(), other.trueArray.get() + trueLen, trueArray.get());
-    std::copy(other.falseArray.get(), other.falseArray.get() + falseLen, falseArray.get());
-}
-
-Node& Node::operator=(const Node& other)
-{
-    state = other.state;
-    trueInLen = other.trueInLen; trueOutLen = other.trueOutLen;
-    falseInLen = other.falseInLen; falseOutLen = other.falseOutLen;
-    TLinkID trueLen = trueInLen + trueOutLen;
-    TLinkID falseLen = falseInLen + falseOutLen;
-    trueArray = std::make_unique<TLinkID[]>(trueLen);
-    falseArray = std::make_unique<TLinkID[]>(falseLen);
-    std::copy(other.trueArray.get(), other.trueArray.get() + trueLen, trueArray.get());
-    std::copy(other.falseArray.get(), other.falseArray.get() + falseLen, falseArray.get());
+typedef unsigned long long TMask;
+// Shortest segment worth scanning as a run of consecutive node IDs
+static const TNodeID RANGE_MIN = 8;
+// How an added group link is updated by a node of the group, besides IN and OUT
+static const Side GROUP = 2;
+// Fewest out nodes of a lazy link
+static const TNodeID LAZY_MIN = 32;
+
+static inline TMask gatherBits(TMask bytes) noexcept
+{
+    // Bit 0 of each byte to bit i of the result
+    return ((bytes & 0x0101010101010101ULL) * 0x0102040810204080ULL) >> 56;
+}
+
+static inline void maskStates(const State* ptr, TNodeID size, TMask& trueMask, TMask& maybeMask) noexcept
+{
+    // Up to 64 states to bit masks: bit 0 of a state is set only for TRUE, bit 1 only for MAYBE
+    assert(size <= 64);
+    trueMask = 0;
+    maybeMask = 0;
+    TNodeID i = 0;
+#if defined(__AVX2__)
+    for ( ; i + 32 <= size; i += 32) {
+        const __m256i bytes = _mm256_loadu_si256((const __m256i*) (ptr + i));
+        trueMask |= TMask((unsigned int) _mm256_movemask_epi8(_mm256_slli_epi16(bytes, 7))) << i;
+        maybeMask |= TMask((unsigned int) _mm256_movemask_epi8(_mm256_slli_epi16(bytes, 6))) << i;
+    }
+#endif
+    for ( ; i + 8 <= size; i += 8) {
+        TMask bytes;
+        std::memcpy(&bytes, ptr + i, 8);
+        trueMask |= gatherBits(bytes) << i;
+        maybeMask |= gatherBits(bytes >> 1) << i;
+    }
+    for ( ; i < size; i++) {
+        trueMask |= TMask(ptr[i] == TRUE) << i;
+        maybeMask |= TMask(ptr[i] == MAYBE) << i;
+    }
+}
+
+template<typename TNodeID>
+static unsigned char getRanges(const TNodeID* linkNodeArray, const TOffset* offsetPtr) noexcept
+{
+    // Bit k set: link segment k is a run of consecutive node IDs
+    unsigned char ranges = 0;
+    for (TOffset k = 0; k < 4; k++) {
+        const TNodeID* ptr = linkNodeArray + offsetPtr[k];
+        const TNodeID* endPtr = linkNodeArray + offsetPtr[k + 1];
+        if (endPtr - ptr < RANGE_MIN) continue;
+        bool isRange = true;
+        for (const TNodeID* runPtr = ptr + 1; runPtr < endPtr && isRange; runPtr++)
+            isRange = *runPtr == *(runPtr - 1) + 1;
+        if (isRange) ranges |= 1 << k;
+    }
+    return ranges;
+}
+
+// Each counter has one writer, so a relaxed load and store does without a locked add
+static inline void increment(std::atomic<TCount>& counter, const TCount amount = 1) noexcept
+{
+    counter.store(counter.load(std::memory_order_relaxed) + amount, std::memory_order_relaxed);
+}
+
+static inline void raise(std::atomic<TCount>& counter, const TCount value) noexcept
+{
+    if (value > counter.load(std::memory_order_relaxed)) counter.store(value, std::memory_order_relaxed);
+}
+
+Statistics::Statistics() noexcept
+    : decisionCount(0), propagationCount(0), conflictCount(0), restartCount(0), undoLinkCount(0),
+      maxTrailDepth(0), maxBoundDepth(0), linkCountVector() {}
+
+Statistics::Statistics(const Statistics& other)
+    : decisionCount(other.decisionCount.load()), propagationCount(other.propagationCount.load()),
+      conflictCount(other.conflictCount.load()), restartCount(other.restartCount.load()),
+      undoLinkCount(other.undoLinkCount.load()),
+      maxTrailDepth(other.maxTrailDepth.load()), maxBoundDepth(other.maxBoundDepth.load()),
+      linkCountVector(other.linkCountVector.size())
+{
+    for (size_t linkID = 0; linkID < linkCountVector.size(); linkID++)
+        linkCountVector[linkID] = other.linkCountVector[linkID].load();
+}
+
+Statistics& Statistics::operator=(const Statistics& other)
+{
+    decisionCount = other.decisionCount.load();
+    propagationCount = other.propagationCount.load();
+    conflictCount = other.conflictCount.load();
+    restartCount = other.restartCount.load();
+    undoLinkCount = other.undoLinkCount.load();
+    maxTrailDepth = other.maxTrailDepth.load();
+    maxBoundDepth = other.maxBoundDepth.load();
+    linkCountVector = vector<std::atomic<TCount>>(other.linkCountVector.size());
+    for (size_t linkID = 0; linkID < linkCountVector.size(); linkID++)
+        linkCountVector[linkID] = other.linkCountVector[linkID].load();
     return *this;
 }
 
-Node::Node(Node&& other) noexcept
-    : state(other.state),
-      trueInLen(other.trueInLen), trueOutLen(other.trueOutLen),
-      falseInLen(other.falseInLen), falseOutLen(other.falseOutLen),
-      trueArray(std::move(other.trueArray)),
-      falseArray(std::move(other.falseArray)) {}
+Statistics::Statistics(Statistics&& other) noexcept
+    : decisionCount(other.decisionCount.load()), propagationCount(other.propagationCount.load()),
+      conflictCount(other.conflictCount.load()), restartCount(other.restartCount.load()),
+      undoLinkCount(other.undoLinkCount.load()),
+      maxTrailDepth(other.maxTrailDepth.load()), maxBoundDepth(other.maxBoundDepth.load()),
+      linkCountVector(std::move(other.linkCountVector)) {}
 
-Node& Node::operator=(Node&& other) noexcept
+Statistics& Statistics::operator=(Statistics&& other) noexcept
 {
-    state = other.state;
-    trueInLen = other.trueInLen; trueOutLen = other.trueOutLen;
-    falseInLen = other.falseInLen; falseOutLen = other.falseOutLen;
-    trueArray = std::move(other.trueArray);
-    falseArray = std::move(other.falseArray);
+    decisionCount = other.decisionCount.load();
+    propagationCount = other.propagationCount.load();
+    conflictCount = other.conflictCount.load();
+    restartCount = other.restartCount.load();
+    undoLinkCount = other.undoLinkCount.load();
+    maxTrailDepth = other.maxTrailDepth.load();
+    maxBoundDepth = other.maxBoundDepth.load();
+    linkCountVector = std::move(other.linkCountVector);
     return *this;
 }
 
-Node::Node() noexcept
-    : state(MAYBE),
-      trueInLen(0), trueOutLen(0), trueArray(),
-      falseInLen(0), falseOutLen(0), falseArray() {}
+void Statistics::add(const Statistics& copy, const Statistics& base) noexcept
+{
+    increment(decisionCount, copy.decisionCount - base.decisionCount);
+    increment(propagationCount, copy.propagationCount - base.propagationCount);
+    increment(conflictCount, copy.conflictCount - base.conflictCount);
+    increment(restartCount, copy.restartCount - base.restartCount);
+    increment(undoLinkCount, copy.undoLinkCount - base.undoLinkCount);
+    raise(maxTrailDepth, copy.maxTrailDepth);
+    raise(maxBoundDepth, copy.maxBoundDepth);
+    for (size_t linkID = 0; linkID < linkCountVector.size() && linkID < copy.linkCountVector.size(); linkID++)
+        increment(linkCountVector[linkID], copy.linkCountVector[linkID] - 
+            (linkID < base.linkCountVector.size() ? base.linkCountVector[linkID].load() : 0));
+}
 
-Node::Node(
-    const vector<TLinkID>& trueInLinks, const vector<TLinkID>& trueOutLinks,
-    const vector<TLinkID>& falseInLinks, const vector<TLinkID>& falseOutLinks)
-    : state(MAYBE),
-      trueInLen(trueInLinks.size()), trueOutLen(trueOutLinks.size()),
-      falseInLen(falseInLinks.size()), falseOutLen(falseOutLinks.size())
+void Statistics::assignCounts(const Statistics& other) noexcept
 {
-    TLinkID trueLen = trueInLen + trueOutLen;
-    TLinkID falseLen = falseInLen + falseOutLen;
-    trueArray = std::make_unique<TLinkID[]>(trueLen);
-    falseArray = std::make_unique<TLinkID[]>(falseLen);
-    std::copy(trueInLinks.cbegin(), trueInLinks.cend(), trueArray.get());
-    std::copy(trueOutLinks.cbegin(), trueOutLinks.cend(), trueArray.get() + trueInLen);
-    std::copy(falseInLinks.cbegin(), falseInLinks.cend(), falseArray.get());
-    std::copy(falseOutLinks.cbegin(), falseOutLinks.cend(), falseArray.get() + falseInLen);
+    decisionCount.store(other.decisionCount.load(std::memory_order_relaxed), std::memory_order_relaxed);
+    propagationCount.store(other.propagationCount.load(std::memory_order_relaxed), std::memory_order_relaxed);
+    conflictCount.store(other.conflictCount.load(std::memory_order_relaxed), std::memory_order_relaxed);
+    restartCount.store(other.restartCount.load(std::memory_order_relaxed), std::memory_order_relaxed);
+    undoLinkCount.store(other.undoLinkCount.load(std::memory_order_relaxed), std::memory_order_relaxed);
+    maxTrailDepth.store(other.maxTrailDepth.load(std::memory_order_relaxed), std::memory_order_relaxed);
+    maxBoundDepth.store(other.maxBoundDepth.load(std::memory_order_relaxed), std::memory_order_relaxed);
 }
 
-Link::Link(const Link& other)
-    : inCount(other.inCount), outCount(other.outCount),
-      inLimit(other.inLimit), outLimit(other.outLimit),
+Limits::Limits() noexcept
+    : deadline(std::chrono::steady_clock::time_point::max()),
+      decisionBudget(0), conflictBudget(0), cancel(nullptr) {}
+
+template<typename TNodeID>
+BasicLink<TNodeID>::BasicLink(const BasicLink& other)
+    : kind(other.kind), inLimit(other.inLimit), outLimit(other.outLimit),
       trueOutLen(other.trueOutLen), falseOutLen(other.falseOutLen),
       trueInLen(other.trueInLen), falseInLen(other.falseInLen)
 {
@@ -86,9 +178,10 @@ Link::Link(const Link& other)
     std::copy(other.inArray.get(), other.inArray.get() + inLen, inArray.get());
 }
 
-Link& Link::operator=(const Link& other)
+template<typename TNodeID>
+BasicLink<TNodeID>& BasicLink<TNodeID>::operator=(const BasicLink& other)
 {
-    inCount = other.inCount; outCount = other.outCount;
+    kind = other.kind;
     inLimit = other.inLimit; outLimit = other.outLimit;
     trueOutLen = other.trueOutLen; falseOutLen = other.falseOutLen;
     trueInLen = other.trueInLen; falseInLen = other.falseInLen;
@@ -101,17 +194,18 @@ Link& Link::operator=(const Link& other)
     return *this;
 }
 
-Link::Link(Link&& other) noexcept
-    : inCount(other.inCount), outCount(other.outCount),
-      inLimit(other.inLimit), outLimit(other.outLimit),
+template<typename TNodeID>
+BasicLink<TNodeID>::BasicLink(BasicLink&& other) noexcept
+    : kind(other.kind), inLimit(other.inLimit), outLimit(other.outLimit),
       trueOutLen(other.trueOutLen), falseOutLen(other.falseOutLen),
       trueInLen(other.trueInLen), falseInLen(other.falseInLen),
       outArray(std::move(other.outArray)),
       inArray(std::move(other.inArray)) {}
 
-Link& Link::operator=(Link&& other) noexcept
+template<typename TNodeID>
+BasicLink<TNodeID>& BasicLink<TNodeID>::operator=(BasicLink&& other) noexcept
 {
-    inCount = other.inCount; outCount = other.outCount;
+    kind = other.kind;
     inLimit = other.inLimit; outLimit = other.outLimit;
     trueOutLen = other.trueOutLen; falseOutLen = other.falseOutLen;
     trueInLen = other.trueInLen; falseInLen = other.falseInLen;
@@ -120,475 +214,2648 @@ Link& Link::operator=(Link&& other) noexcept
     return *this;
 }
 
-Link::Link() noexcept
-    : inCount(0), outCount(0),
-      inLimit(0), outLimit(0),
+template<typename TNodeID>
+BasicLink<TNodeID>::BasicLink() noexcept
+    : kind(GENERIC), inLimit(0), outLimit(0),
       trueOutLen(0), falseOutLen(0), outArray(),
       trueInLen(0), falseInLen(0), inArray() {}
 
-Link::Link(
+template<typename TNodeID>
+BasicLink<TNodeID>::BasicLink(
     const vector<TNodeID>& trueInNodes,
     const vector<TNodeID>& falseInNodes,
     Equality inEquality, TNodeID inLimit,
     const vector<TNodeID>& trueOutNodes,
     const vector<TNodeID>& falseOutNodes,
     Equality outEquality, TNodeID outLimit)
-    : inCount(0), outCount(0)
+    : kind(GENERIC)
 {
     // In
     TNodeID inLen = trueInNodes.size() + falseInNodes.size();
-    Link::inArray = std::make_unique<TNodeID[]>(inLen);
+    BasicLink::inArray = std::make_unique<TNodeID[]>(inLen);
     if (inEquality & IS_GREATER) {
-        Link::trueInLen = trueInNodes.size();
-        Link::falseInLen = falseInNodes.size();
-        std::copy(trueInNodes.cbegin(), trueInNodes.cend(), Link::inArray.get());
-        std::copy(falseInNodes.cbegin(), falseInNodes.cend(), Link::inArray.get() + trueInNodes.size());
+        BasicLink::trueInLen = trueInNodes.size();
+        BasicLink::falseInLen = falseInNodes.size();
+        std::copy(trueInNodes.cbegin(), trueInNodes.cend(), BasicLink::inArray.get());
+        std::copy(falseInNodes.cbegin(), falseInNodes.cend(), BasicLink::inArray.get() + trueInNodes.size());
     } else {
-        Link::trueInLen = falseInNodes.size();
-        Link::falseInLen = trueInNodes.size();
-        std::copy(falseInNodes.cbegin(), falseInNodes.cend(), Link::inArray.get());
-        std::copy(trueInNodes.cbegin(), trueInNodes.cend(), Link::inArray.get() + falseInNodes.size());
+        BasicLink::trueInLen = falseInNodes.size();
+        BasicLink::falseInLen = trueInNodes.size();
+        std::copy(falseInNodes.cbegin(), falseInNodes.cend(), BasicLink::inArray.get());
+        std::copy(trueInNodes.cbegin(), trueInNodes.cend(), BasicLink::inArray.get() + falseInNodes.size());
         inLimit = inLen - inLimit;
     }
     // if (!(inEquality & IS_EQUAL)) inLimit += 1;
     // Link::inLimit = inLimit - 1;
     if (inEquality & IS_EQUAL) inLimit -= 1;
-    Link::inLimit = inLimit;
+    BasicLink::inLimit = inLimit;
     // Out
     TNodeID outLen = trueOutNodes.size() + falseOutNodes.size();
-    Link::outArray = std::make_unique<TNodeID[]>(outLen);
+    BasicLink::outArray = std::make_unique<TNodeID[]>(outLen);
     if (!(outEquality & IS_GREATER)) {
-        Link::trueOutLen = trueOutNodes.size();
-        Link::falseOutLen = falseOutNodes.size();
-        std::copy(trueOutNodes.cbegin(), trueOutNodes.cend(), Link::outArray.get());
-        std::copy(falseOutNodes.cbegin(), falseOutNodes.cend(), Link::outArray.get() + trueOutNodes.size());
+        BasicLink::trueOutLen = trueOutNodes.size();
+        BasicLink::falseOutLen = falseOutNodes.size();
+        std::copy(trueOutNodes.cbegin(), trueOutNodes.cend(), BasicLink::outArray.get());
+        std::copy(falseOutNodes.cbegin(), falseOutNodes.cend(), BasicLink::outArray.get() + trueOutNodes.size());
     } else {
-        Link::trueOutLen = falseOutNodes.size();
-        Link::falseOutLen = trueOutNodes.size();
-        std::copy(falseOutNodes.cbegin(), falseOutNodes.cend(), Link::outArray.get());
-        std::copy(trueOutNodes.cbegin(), trueOutNodes.cend(), Link::outArray.get() + falseOutNodes.size());
+        BasicLink::trueOutLen = falseOutNodes.size();
+        BasicLink::falseOutLen = trueOutNodes.size();
+        std::copy(falseOutNodes.cbegin(), falseOutNodes.cend(), BasicLink::outArray.get());
+        std::copy(trueOutNodes.cbegin(), trueOutNodes.cend(), BasicLink::outArray.get() + falseOutNodes.size());
         outLimit = outLen - outLimit;
     }
     if (!(outEquality & IS_EQUAL)) outLimit -= 1;
-    Link::outLimit = outLimit;
+    BasicLink::outLimit = outLimit;
 }
 
-bool Link::isJustConditional() const noexcept
+template<typename TNodeID>
+BasicLink<TNodeID>::BasicLink(Kind kind, const vector<TNodeID>& nodes)
+    : kind(kind),
+      trueOutLen(nodes.size()), falseOutLen(0), outArray(std::make_unique<TNodeID[]>(nodes.size())),
+      trueInLen(0), falseInLen(0), inArray()
+{
+    // Fires on the first TRUE node, or on the last node not yet FALSE
+    assert(kind == AT_MOST_ONE || kind == EXACTLY_ONE);
+    std::copy(nodes.cbegin(), nodes.cend(), outArray.get());
+    inLimit = kind == EXACTLY_ONE ? TNodeID(nodes.size() - 1) : TNodeID(~TNodeID(0));
+    outLimit = 1;
+}
+
+
+template<typename TNodeID, typename TLinkID>
+bool BasicEngine<TNodeID,TLinkID>::Counter::isJustConditional() const noexcept
 {
-    // Just Conditional
-    bool e_ge = inCount == inLimit + 1 && outCount >= outLimit;
-    bool ge_e = inCount >= inLimit + 1 && outCount == outLimit;
+    // Just Conditional (limits may wrap, also when narrower than int)
+    const TNodeID inNext = inLimit + 1;
+    bool e_ge = inCount == inNext && outCount >= outLimit;
+    bool ge_e = inCount >= inNext && outCount == outLimit;
     return e_ge || ge_e;
 }
 
-bool Link::isJustContrapositive() const noexcept
+template<typename TNodeID, typename TLinkID>
+bool BasicEngine<TNodeID,TLinkID>::Counter::isJustContrapositive() const noexcept
 {
     // Just Contrapositive
-    bool e_ge = inCount == inLimit && outCount >= outLimit + 1;
-    bool ge_e = inCount >= inLimit && outCount == outLimit + 1;
+    const TNodeID outNext = outLimit + 1;
+    bool e_ge = inCount == inLimit && outCount >= outNext;
+    bool ge_e = inCount >= inLimit && outCount == outNext;
     return e_ge || ge_e;
 }
 
-bool Link::isJustNotConditional() const noexcept
+template<typename TNodeID, typename TLinkID>
+TNodeID BasicEngine<TNodeID,TLinkID>::Counter::getSlack() const noexcept
 {
-    // Just Not Conditional
-    bool e_ge = inCount == inLimit && outCount <= outLimit - 1;
-    bool ge_e = inCount <= inLimit && outCount == outLimit - 1;
-    return e_ge || ge_e;
+    // Count increments left before the link fires either way (limits may wrap)
+    typedef unsigned long long TSlack;
+    const TSlack maxSlack = TNodeID(~TNodeID(0));
+    const TNodeID inNext = inLimit + 1;
+    const TNodeID outNext = outLimit + 1;
+    TNodeID inNeed = inCount >= inNext ? 0 : inNext - inCount;
+    TNodeID outNeed = outCount >= outLimit ? 0 : outLimit - outCount;
+    TNodeID inNotNeed = inCount >= inLimit ? 0 : inLimit - inCount;
+    TNodeID outNotNeed = outCount >= outNext ? 0 : outNext - outCount;
+    TSlack conditional = TSlack(inNeed) + outNeed;
+    TSlack contrapositive = TSlack(inNotNeed) + outNotNeed;
+    return std::min(std::min(conditional, contrapositive), maxSlack);
 }
 
-bool Link::isJustNotContrapositive() const noexcept
+template<typename TNodeID, typename TLinkID>
+TNodeID BasicEngine<TNodeID,TLinkID>::Counter::getGroupSlack() const noexcept
 {
-    // Just Not Contrapositive
-    bool e_ge = inCount == inLimit - 1 && outCount <= outLimit;
-    bool ge_e = inCount <= inLimit - 1 && outCount == outLimit;
-    return e_ge || ge_e;
+    TNodeID trueNeed = outCount >= outLimit ? 0 : outLimit - outCount;
+    TNodeID falseNeed = inCount >= inLimit ? 0 : inLimit - inCount;
+    return std::min(trueNeed, falseNeed);
 }
 
-Engine::Bound::Bound() noexcept
-    : trueNodeIDPtr(nullptr), falseNodeIDPtr(nullptr), state(TRUE) {}
+template<typename TNodeID, typename TLinkID>
+BasicEngine<TNodeID,TLinkID>::Bound::Bound() noexcept
+    : trueNodeIDPtr(nullptr), falseNodeIDPtr(nullptr),
+      nodeID(0), nodeState(TRUE), state(TRUE) {}
+
+template<typename TNodeID, typename TLinkID>
+BasicEngine<TNodeID,TLinkID>::Bound::Bound(TNodeID* trueNodeIDPtr, TNodeID* falseNodeIDPtr, State state) noexcept
+    : trueNodeIDPtr(trueNodeIDPtr), falseNodeIDPtr(falseNodeIDPtr),
+      nodeID(0), nodeState(TRUE), state(state) {}
+
+template<typename TNodeID, typename TLinkID>
+struct BasicEngine<TNodeID,TLinkID>::Split
+{
+    std::mutex mutex;
+    std::condition_variable condition;
+    // Subproblems waiting for a worker, as decisions to replay on the root engine
+    vector<vector<pair<TNodeID,bool>>> pathVector;
+    unsigned int busyCount;
+    std::atomic<unsigned int> idleCount;
+    std::atomic<bool> stop;
+    // Stopped by the limits: workers leave what they had not searched in pathVector
+    std::atomic<bool> limited;
+    unsigned int exitCount;
+    std::condition_variable exitCondition;
+    BasicEngine* solution;
+    Split() noexcept : busyCount(0), idleCount(0), stop(false), limited(false), exitCount(0), solution(nullptr) {}
+};
 
-Engine::Bound::Bound(TNodeID* trueNodeIDPtr, TNodeID* falseNodeIDPtr, State state) noexcept
-    : trueNodeIDPtr(trueNodeIDPtr), falseNodeIDPtr(falseNodeIDPtr), state(state) {}
+template<typename TNodeID, typename TLinkID>
+struct BasicEngine<TNodeID,TLinkID>::Budget
+{
+    // Limits of a solve call, with the budgets as totals of the engine's counters
+    std::chrono::steady_clock::time_point deadline;
+    TCount decisionCount, conflictCount;
+    const std::atomic<bool>* cancel;
+    bool isOver(const TCount decisions, const TCount conflicts, const bool timed) const noexcept
+    {
+        return decisions >= decisionCount || conflicts >= conflictCount ||
+            (cancel != nullptr && cancel->load(std::memory_order_relaxed)) ||
+            (timed && std::chrono::steady_clock::now() >= deadline);
+    }
+};
 
-Engine::Engine() noexcept
-    : nodeVector(), linkVector(),
-      nodeIDArray(), boundArray() {}
+template<typename TNodeID, typename TLinkID>
+BasicEngine<TNodeID,TLinkID>::BasicEngine() noexcept
+    : problem(), stateVector(), counterVector(),
+      changeVector(), changeStampVector(), changeMarkVector(), changeStamp(0),
+      addKindVector(), addRangeVector(), addLinkOffsetVector(), addLinkNodeVector(), addNodeLinkVector(),
+      nodeIDArray(), boundArray(),
+      trueNodeIDPtrTop(nullptr), falseNodeIDPtrTop(nullptr),
+      heuristic(ORDER), phaseSaving(false), phaseVector(),
+      activityHeap(), activityIncrement(1),
+      slackHeap(), slackParkVector(),
+      conflictLinkID(0),
+      restart(NEVER), restartUnit(100), restartIndex(0), restartLimit(0),
+      reasonVector(), levelVector(), orderVector(),
+      level(0), order(0),
+      learning(false), learnLimit(1 << 14), learnIncrement(1),
+      learnVector(), learnNodeVector(), watchVector(),
+      lazyVector(), lazyNodeVector(), lazyWatchVector(),
+      learnBuffer(), learnLevel(0),
+      seenVector(), seenNodeVector(), analyzeHeap(),
+      assumeVector(),
+      split(nullptr), splitPath(), splitDepth(0),
+      resumeDepth(NONE), resumePathVector(),
+      statistics() {}
 
-Engine::Engine(const Engine& other)
-    : nodeVector(other.nodeVector),
-      linkVector(other.linkVector)
+template<typename TNodeID, typename TLinkID>
+BasicEngine<TNodeID,TLinkID>::BasicEngine(const BasicEngine& other)
+    : problem(other.problem),
+      stateVector(other.stateVector),
+      counterVector(other.counterVector),
+      changeVector(other.changeVector), changeStampVector(other.changeStampVector),
+      changeMarkVector(other.changeMarkVector), changeStamp(other.changeStamp),
+      addKindVector(other.addKindVector), addRangeVector(other.addRangeVector),
+      addLinkOffsetVector(other.addLinkOffsetVector), addLinkNodeVector(other.addLinkNodeVector),
+      addNodeLinkVector(other.addNodeLinkVector),
+      nodeIDArray(std::make_unique<TNodeID[]>(other.stateVector.size())),
+      boundArray(std::make_unique<Bound[]>(other.stateVector.size() + 1)),
+      trueNodeIDPtrTop(nodeIDArray.get() + (other.trueNodeIDPtrTop - other.nodeIDArray.get())),
+      falseNodeIDPtrTop(nodeIDArray.get() + (other.falseNodeIDPtrTop - other.nodeIDArray.get())),
+      heuristic(other.heuristic), phaseSaving(other.phaseSaving),
+      phaseVector(other.phaseVector),
+      activityHeap(other.activityHeap), activityIncrement(other.activityIncrement),
+      slackHeap(other.slackHeap), slackParkVector(other.slackParkVector),
+      conflictLinkID(other.conflictLinkID),
+      restart(other.restart), restartUnit(other.restartUnit),
+      restartIndex(other.restartIndex), restartLimit(other.restartLimit),
+      reasonVector(other.reasonVector), levelVector(other.levelVector), orderVector(other.orderVector),
+      level(other.level), order(other.order),
+      learning(other.learning), learnLimit(other.learnLimit), learnIncrement(other.learnIncrement),
+      learnVector(other.learnVector), learnNodeVector(other.learnNodeVector), watchVector(other.watchVector),
+      lazyVector(other.lazyVector), lazyNodeVector(other.lazyNodeVector), lazyWatchVector(other.lazyWatchVector),
+      learnBuffer(other.learnBuffer), learnLevel(other.learnLevel),
+      seenVector(other.seenVector), seenNodeVector(other.seenNodeVector), analyzeHeap(other.analyzeHeap),
+      assumeVector(other.assumeVector),
+      split(nullptr), splitPath(other.splitPath), splitDepth(other.splitDepth),
+      resumeDepth(other.resumeDepth), resumePathVector(other.resumePathVector),
+      statistics(other.statistics)
 {
-    nodeIDArray = std::make_unique<TNodeID[]>(nodeVector.size());
-    std::copy(other.nodeIDArray.get(), other.nodeIDArray.get() + other.nodeVector.size(), nodeIDArray.get());
-    std::copy(other.boundArray.get(), other.boundArray.get() + other.nodeVector.size(), boundArray.get());
+    std::copy(other.nodeIDArray.get(), other.nodeIDArray.get() + other.stateVector.size(), nodeIDArray.get());
+    copyBoundArray(other);
 }
 
-Engine& Engine::operator=(const Engine& other)
+template<typename TNodeID, typename TLinkID>
+BasicEngine<TNodeID,TLinkID>& BasicEngine<TNodeID,TLinkID>::operator=(const BasicEngine& other)
 {
-    nodeVector = other.nodeVector;
-    linkVector = other.linkVector;
-    nodeIDArray = std::make_unique<TNodeID[]>(nodeVector.size());
-    std::copy(other.nodeIDArray.get(), other.nodeIDArray.get() + other.nodeVector.size(), nodeIDArray.get());
-    std::copy(other.boundArray.get(), other.boundArray.get() + other.nodeVector.size(), boundArray.get());
+    problem = other.problem;
+    stateVector = other.stateVector;
+    counterVector = other.counterVector;
+    changeVector = other.changeVector;
+    changeStampVector = other.changeStampVector;
+    changeMarkVector = other.changeMarkVector;
+    changeStamp = other.changeStamp;
+    addKindVector = other.addKindVector;
+    addRangeVector = other.addRangeVector;
+    addLinkOffsetVector = other.addLinkOffsetVector;
+    addLinkNodeVector = other.addLinkNodeVector;
+    addNodeLinkVector = other.addNodeLinkVector;
+    nodeIDArray = std::make_unique<TNodeID[]>(stateVector.size());
+    boundArray = std::make_unique<Bound[]>(stateVector.size() + 1);
+    trueNodeIDPtrTop = nodeIDArray.get() + (other.trueNodeIDPtrTop - other.nodeIDArray.get());
+    falseNodeIDPtrTop = nodeIDArray.get() + (other.falseNodeIDPtrTop - other.nodeIDArray.get());
+    heuristic = other.heuristic;
+    phaseSaving = other.phaseSaving;
+    phaseVector = other.phaseVector;
+    activityHeap = other.activityHeap;
+    activityIncrement = other.activityIncrement;
+    slackHeap = other.slackHeap;
+    slackParkVector = other.slackParkVector;
+    conflictLinkID = other.conflictLinkID;
+    restart = other.restart;
+    restartUnit = other.restartUnit;
+    restartIndex = other.restartIndex;
+    restartLimit = other.restartLimit;
+    reasonVector = other.reasonVector;
+    levelVector = other.levelVector;
+    orderVector = other.orderVector;
+    level = other.level;
+    order = other.order;
+    learning = other.learning;
+    learnLimit = other.learnLimit;
+    learnIncrement = other.learnIncrement;
+    learnVector = other.learnVector;
+    learnNodeVector = other.learnNodeVector;
+    watchVector = other.watchVector;
+    lazyVector = other.lazyVector;
+    lazyNodeVector = other.lazyNodeVector;
+    lazyWatchVector = other.lazyWatchVector;
+    learnBuffer = other.learnBuffer;
+    learnLevel = other.learnLevel;
+    seenVector = other.seenVector;
+    seenNodeVector = other.seenNodeVector;
+    analyzeHeap = other.analyzeHeap;
+    assumeVector = other.assumeVector;
+    split = nullptr;
+    splitPath = other.splitPath;
+    splitDepth = other.splitDepth;
+    resumeDepth = other.resumeDepth;
+    resumePathVector = other.resumePathVector;
+    statistics = other.statistics;
+    std::copy(other.nodeIDArray.get(), other.nodeIDArray.get() + other.stateVector.size(), nodeIDArray.get());
+    copyBoundArray(other);
     return *this;
 }
 
-Engine::Engine(Engine&& other) noexcept
-    : nodeVector(std::move(other.nodeVector)),
-      linkVector(std::move(other.linkVector)),
+template<typename TNodeID, typename TLinkID>
+BasicEngine<TNodeID,TLinkID>::BasicEngine(BasicEngine&& other) noexcept
+    : problem(std::move(other.problem)),
+      stateVector(std::move(other.stateVector)),
+      counterVector(std::move(other.counterVector)),
+      changeVector(std::move(other.changeVector)), changeStampVector(std::move(other.changeStampVector)),
+      changeMarkVector(std::move(other.changeMarkVector)), changeStamp(other.changeStamp),
+      addKindVector(std::move(other.addKindVector)), addRangeVector(std::move(other.addRangeVector)),
+      addLinkOffsetVector(std::move(other.addLinkOffsetVector)), addLinkNodeVector(std::move(other.addLinkNodeVector)),
+      addNodeLinkVector(std::move(other.addNodeLinkVector)),
       nodeIDArray(std::move(other.nodeIDArray)),
-      boundArray(std::move(other.boundArray)) {}
+      boundArray(std::move(other.boundArray)),
+      trueNodeIDPtrTop(other.trueNodeIDPtrTop), falseNodeIDPtrTop(other.falseNodeIDPtrTop),
+      heuristic(other.heuristic), phaseSaving(other.phaseSaving),
+      phaseVector(std::move(other.phaseVector)),
+      activityHeap(std::move(other.activityHeap)), activityIncrement(other.activityIncrement),
+      slackHeap(std::move(other.slackHeap)), slackParkVector(std::move(other.slackParkVector)),
+      conflictLinkID(other.conflictLinkID),
+      restart(other.restart), restartUnit(other.restartUnit),
+      restartIndex(other.restartIndex), restartLimit(other.restartLimit),
+      reasonVector(std::move(other.reasonVector)), levelVector(std::move(other.levelVector)),
+      orderVector(std::move(other.orderVector)),
+      level(other.level), order(other.order),
+      learning(other.learning), learnLimit(other.learnLimit), learnIncrement(other.learnIncrement),
+      learnVector(std::move(other.learnVector)), learnNodeVector(std::move(other.learnNodeVector)),
+      watchVector(std::move(other.watchVector)),
+      lazyVector(std::move(other.lazyVector)), lazyNodeVector(std::move(other.lazyNodeVector)),
+      lazyWatchVector(std::move(other.lazyWatchVector)),
+      learnBuffer(std::move(other.learnBuffer)), learnLevel(other.learnLevel),
+      seenVector(std::move(other.seenVector)), seenNodeVector(std::move(other.seenNodeVector)),
+      analyzeHeap(std::move(other.analyzeHeap)),
+      assumeVector(std::move(other.assumeVector)),
+      split(other.split), splitPath(std::move(other.splitPath)), splitDepth(other.splitDepth),
+      resumeDepth(other.resumeDepth), resumePathVector(std::move(other.resumePathVector)),
+      statistics(std::move(other.statistics)) {}
 
-Engine& Engine::operator=(Engine&& other) noexcept
+template<typename TNodeID, typename TLinkID>
+BasicEngine<TNodeID,TLinkID>& BasicEngine<TNodeID,TLinkID>::operator=(BasicEngine&& other) noexcept
 {
-    nodeVector = std::move(other.nodeVector);
-    linkVector = std::move(other.linkVector);
+    problem = std::move(other.problem);
+    stateVector = std::move(other.stateVector);
+    counterVector = std::move(other.counterVector);
+    changeVector = std::move(other.changeVector);
+    changeStampVector = std::move(other.changeStampVector);
+    changeMarkVector = std::move(other.changeMarkVector);
+    changeStamp = other.changeStamp;
+    addKindVector = std::move(other.addKindVector);
+    addRangeVector = std::move(other.addRangeVector);
+    addLinkOffsetVector = std::move(other.addLinkOffsetVector);
+    addLinkNodeVector = std::move(other.addLinkNodeVector);
+    addNodeLinkVector = std::move(other.addNodeLinkVector);
     nodeIDArray = std::move(other.nodeIDArray);
     boundArray = std::move(other.boundArray);
+    trueNodeIDPtrTop = other.trueNodeIDPtrTop;
+    falseNodeIDPtrTop = other.falseNodeIDPtrTop;
+    heuristic = other.heuristic;
+    phaseSaving = other.phaseSaving;
+    phaseVector = std::move(other.phaseVector);
+    activityHeap = std::move(other.activityHeap);
+    activityIncrement = other.activityIncrement;
+    slackHeap = std::move(other.slackHeap);
+    slackParkVector = std::move(other.slackParkVector);
+    conflictLinkID = other.conflictLinkID;
+    restart = other.restart;
+    restartUnit = other.restartUnit;
+    restartIndex = other.restartIndex;
+    restartLimit = other.restartLimit;
+    reasonVector = std::move(other.reasonVector);
+    levelVector = std::move(other.levelVector);
+    orderVector = std::move(other.orderVector);
+    level = other.level;
+    order = other.order;
+    learning = other.learning;
+    learnLimit = other.learnLimit;
+    learnIncrement = other.learnIncrement;
+    learnVector = std::move(other.learnVector);
+    learnNodeVector = std::move(other.learnNodeVector);
+    watchVector = std::move(other.watchVector);
+    lazyVector = std::move(other.lazyVector);
+    lazyNodeVector = std::move(other.lazyNodeVector);
+    lazyWatchVector = std::move(other.lazyWatchVector);
+    learnBuffer = std::move(other.learnBuffer);
+    learnLevel = other.learnLevel;
+    seenVector = std::move(other.seenVector);
+    seenNodeVector = std::move(other.seenNodeVector);
+    analyzeHeap = std::move(other.analyzeHeap);
+    assumeVector = std::move(other.assumeVector);
+    split = other.split;
+    splitPath = std::move(other.splitPath);
+    splitDepth = other.splitDepth;
+    resumeDepth = other.resumeDepth;
+    resumePathVector = std::move(other.resumePathVector);
+    statistics = std::move(other.statistics);
     return *this;
 }
 
-Engine::Engine(const vector<Link>& links, TNodeID nodeSize)
-    : Engine(vector<Link>(links), nodeSize) {}
+template<typename TNodeID, typename TLinkID>
+void BasicEngine<TNodeID,TLinkID>::copyBoundArray(const BasicEngine& other) noexcept
+{
+    // Bounds point into the trail, so a fork rebases them onto its own copy
+    if (!other.boundArray) return;
+    const Bound* otherPtr = other.boundArray.get();
+    const Bound* otherEndPtr = otherPtr + other.stateVector.size() + 1;
+    Bound* ptr = boundArray.get();
+    for ( ; otherPtr < otherEndPtr; otherPtr++, ptr++) {
+        *ptr = *otherPtr;
+        if (otherPtr->trueNodeIDPtr == nullptr) continue;
+        ptr->trueNodeIDPtr = nodeIDArray.get() + (otherPtr->trueNodeIDPtr - other.nodeIDArray.get());
+        ptr->falseNodeIDPtr = nodeIDArray.get() + (otherPtr->falseNodeIDPtr - other.nodeIDArray.get());
+    }
+}
+
+template<typename TNodeID, typename TLinkID>
+inline const TOffset* BasicEngine<TNodeID,TLinkID>::getLinkOffsets(const TLinkID linkID) const noexcept
+{
+    const TLinkID linkSize = problem->linkSize;
+    return linkID < linkSize ? problem->linkOffsetArray + 4 * linkID : addLinkOffsetVector.data() + 4 * (linkID - linkSize);
+}
+
+template<typename TNodeID, typename TLinkID>
+inline const TNodeID* BasicEngine<TNodeID,TLinkID>::getLinkNodes(const TLinkID linkID) const noexcept
+{
+    return linkID < problem->linkSize ? problem->linkNodeArray : addLinkNodeVector.data();
+}
+
+template<typename TNodeID, typename TLinkID>
+inline Kind BasicEngine<TNodeID,TLinkID>::getLinkKind(const TLinkID linkID) const noexcept
+{
+    const TLinkID linkSize = problem->linkSize;
+    return linkID < linkSize ? problem->kindArray[linkID] : addKindVector[linkID - linkSize];
+}
+
+template<typename TNodeID, typename TLinkID>
+inline unsigned char BasicEngine<TNodeID,TLinkID>::getLinkRanges(const TLinkID linkID) const noexcept
+{
+    const TLinkID linkSize = problem->linkSize;
+    return linkID < linkSize ? problem->rangeArray[linkID] : addRangeVector[linkID - linkSize];
+}
+
+template<typename TNodeID, typename TLinkID>
+BasicProblem<TNodeID,TLinkID>::BasicProblem(const vector<BasicLink<TNodeID>>& links, TNodeID nodeSize)
+    : BasicProblem(vector<BasicLink<TNodeID>>(links), nodeSize) {}
+
+template<typename TNodeID, typename TLinkID>
+BasicProblem<TNodeID,TLinkID>::BasicProblem() noexcept
+    : nodeSize(0), linkSize(0),
+      nodeOffsetVector(),
+      nodeLinkVector(),
+      kindVector(),
+      limitVector(),
+      rangeVector(),
+      linkOffsetVector(),
+      linkNodeVector(),
+      storage(),
+      nodeOffsetArray(nullptr),
+      nodeLinkArray(nullptr),
+      kindArray(nullptr),
+      limitArray(nullptr),
+      rangeArray(nullptr),
+      linkOffsetArray(nullptr),
+      linkNodeArray(nullptr) {}
 
-Engine::Engine(vector<Link>&& links, TNodeID nodeSize)
-    : linkVector(std::move(links)),
-      nodeVector(nodeSize),
-      nodeIDArray(std::make_unique<TNodeID[]>(nodeSize)),
-      boundArray(std::make_unique<Bound[]>(nodeSize))
+template<typename TNodeID, typename TLinkID>
+BasicProblem<TNodeID,TLinkID>::BasicProblem(vector<BasicLink<TNodeID>>&& links, TNodeID nodeSize)
+    : BasicProblem()
 {
-    // Find Lengths
-    for (const Link& link : linkVector) {
+    const vector<BasicLink<TNodeID>> linkVector(std::move(links));
+    // Link Rows
+    TOffset linkNodeSize = 0;
+    for (const BasicLink<TNodeID>& link : linkVector)
+        linkNodeSize += link.trueInLen + link.falseInLen + link.trueOutLen + link.falseOutLen;
+    kindVector.reserve(linkVector.size());
+    limitVector.reserve(linkVector.size());
+    linkOffsetVector.reserve(4 * linkVector.size() + 1);
+    linkNodeVector.reserve(linkNodeSize);
+    linkOffsetVector.push_back(0);
+    for (const BasicLink<TNodeID>& link : linkVector) {
+        kindVector.push_back(link.kind);
+        limitVector.push_back({link.inLimit, link.outLimit});
         const TNodeID* inPtr = link.inArray.get();
         const TNodeID* outPtr = link.outArray.get();
-        for (const TNodeID* trueInPtr = inPtr + link.trueInLen; inPtr < trueInPtr; inPtr++)
-            nodeVector[*inPtr].trueInLen++;
-        for (const TNodeID* falseInPtr = inPtr + link.falseInLen; inPtr < falseInPtr; inPtr++)
-            nodeVector[*inPtr].falseInLen++;
-        for (const TNodeID* trueOutPtr = outPtr + link.trueOutLen; outPtr < trueOutPtr; outPtr++)
-            nodeVector[*outPtr].trueOutLen++;
-        for (const TNodeID* falseOutPtr = outPtr + link.falseOutLen; outPtr < falseOutPtr; outPtr++)
-            nodeVector[*outPtr].falseOutLen++;
-    }
-    for (Node& node : nodeVector) {
-        // Allocate Array
-        node.trueArray = std::make_unique<TLinkID[]>(node.trueInLen + node.trueOutLen);
-        node.falseArray = std::make_unique<TLinkID[]>(node.falseInLen + node.falseOutLen);
-        // Lengths as Indices
-        node.trueOutLen = node.trueInLen;
-        node.falseOutLen = node.falseInLen;
-        node.trueInLen = 0;
-        node.falseInLen = 0;
-    }
-    // Fill Array
-    for (TLinkID i = 0; i < linkVector.size(); i++) {
-        const Link& link = linkVector[i];
+        linkNodeVector.insert(linkNodeVector.end(), inPtr, inPtr + link.trueInLen);
+        linkOffsetVector.push_back(linkNodeVector.size());
+        linkNodeVector.insert(linkNodeVector.end(), inPtr + link.trueInLen, inPtr + link.trueInLen + link.falseInLen);
+        linkOffsetVector.push_back(linkNodeVector.size());
+        linkNodeVector.insert(linkNodeVector.end(), outPtr, outPtr + link.trueOutLen);
+        linkOffsetVector.push_back(linkNodeVector.size());
+        linkNodeVector.insert(linkNodeVector.end(), outPtr + link.trueOutLen, outPtr + link.trueOutLen + link.falseOutLen);
+        linkOffsetVector.push_back(linkNodeVector.size());
+    }
+    build(nodeSize);
+}
+
+template<typename TNodeID, typename TLinkID>
+BasicProblem<TNodeID,TLinkID>::BasicProblem(Kind kind, vector<TNodeID>&& groupNodes, TNodeID groupSize, TNodeID nodeSize)
+    : BasicProblem()
+{
+    // Link Rows: each group's nodes as trueOut, as BasicLink(kind, group) lays them out
+    assert((kind == AT_MOST_ONE || kind == EXACTLY_ONE) && groupSize > 0 && groupNodes.size() % groupSize == 0);
+    const TLinkID linkSize = groupNodes.size() / groupSize;
+    const TNodeID inLimit = kind == EXACTLY_ONE ? TNodeID(groupSize - 1) : TNodeID(~TNodeID(0));
+    kindVector.assign(linkSize, kind);
+    limitVector.assign(linkSize, {inLimit, 1});
+    linkOffsetVector.reserve(4 * linkSize + 1);
+    linkOffsetVector.push_back(0);
+    for (TOffset offset = 0; offset < groupNodes.size(); offset += groupSize) {
+        linkOffsetVector.push_back(offset);
+        linkOffsetVector.push_back(offset);
+        linkOffsetVector.push_back(offset + groupSize);
+        linkOffsetVector.push_back(offset + groupSize);
+    }
+    linkNodeVector = std::move(groupNodes);
+    build(nodeSize);
+}
+
+template<typename TNodeID, typename TLinkID>
+void BasicProblem<TNodeID,TLinkID>::build(TNodeID nodeSize)
+{
+    // Six offsets a node, and every literal's offset, must fit TOffset
+    assert(6 * size_t(nodeSize) + 1 <= TOffset(~TOffset(0)) && linkNodeVector.size() <= TOffset(~TOffset(0)));
+    BasicProblem::nodeSize = nodeSize;
+    nodeOffsetVector.assign(6 * size_t(nodeSize) + 1, 0);
+    // Runs
+    rangeVector.resize(limitVector.size());
+    for (TLinkID i = 0; i < limitVector.size(); i++)
+        rangeVector[i] = getRanges(linkNodeVector.data(), linkOffsetVector.data() + 4 * i);
+    // Lazy: no condition, and at most a quarter of the out nodes, plus one, left
+    // uncounted when it fires; counting every other node would be wasted
+    for (TLinkID i = 0; i < limitVector.size(); i++) {
+        const TOffset* offsetPtr = linkOffsetVector.data() + 4 * i;
+        const TNodeID size = offsetPtr[4] - offsetPtr[2];
+        const auto& [inLimit, outLimit] = limitVector[i];
+        if (kindVector[i] == GENERIC && offsetPtr[0] == offsetPtr[2] && inLimit == TNodeID(~TNodeID(0)) &&
+            size >= LAZY_MIN && outLimit < size && size - outLimit + 1 <= size / 4)
+            kindVector[i] = LAZY;
+    }
+    // Link Segment to Node Segment
+    //   [trueIn | falseIn | trueOut | falseOut] -> [trueIn | trueOut | - | falseIn | falseOut | -]
+    //   A group's nodes go to trueGroup, and to falseGroup too for exactly one
+    const TOffset segments[4] = {0, 3, 1, 4};
+    // Find Lengths, segment k's at k
+    for (TLinkID i = 0; i < limitVector.size(); i++) {
+        if (kindVector[i] == LAZY) continue;
+        for (TOffset k = 0; k < 4; k++) {
+            const TNodeID* ptr = linkNodeVector.data() + linkOffsetVector[4 * i + k];
+            const TNodeID* endPtr = linkNodeVector.data() + linkOffsetVector[4 * i + k + 1];
+            for ( ; ptr < endPtr; ptr++) {
+                if (kindVector[i] == GENERIC) {
+                    nodeOffsetVector[6 * size_t(*ptr) + segments[k]]++;
+                    continue;
+                }
+                nodeOffsetVector[6 * size_t(*ptr) + 2]++;
+                if (kindVector[i] == EXACTLY_ONE) nodeOffsetVector[6 * size_t(*ptr) + 5]++;
+            }
+        }
+    }
+    // Lengths to Segment Ends
+    for (TOffset i = 1; i < nodeOffsetVector.size(); i++)
+        nodeOffsetVector[i] += nodeOffsetVector[i - 1];
+    // Fill Rows from the back, leaving each end at its segment's start
+    nodeLinkVector.resize(nodeOffsetVector.back());
+    for (TLinkID i = limitVector.size(); i-- > 0; ) {
+        if (kindVector[i] == LAZY) continue;
+        for (TOffset k = 4; k-- > 0; ) {
+            const TNodeID* ptr = linkNodeVector.data() + linkOffsetVector[4 * i + k + 1];
+            const TNodeID* beginPtr = linkNodeVector.data() + linkOffsetVector[4 * i + k];
+            while (ptr > beginPtr) {
+                --ptr;
+                if (kindVector[i] == GENERIC) {
+                    nodeLinkVector[--nodeOffsetVector[6 * size_t(*ptr) + segments[k]]] = i;
+                    continue;
+                }
+                if (kindVector[i] == EXACTLY_ONE) nodeLinkVector[--nodeOffsetVector[6 * size_t(*ptr) + 5]] = i;
+                nodeLinkVector[--nodeOffsetVector[6 * size_t(*ptr) + 2]] = i;
+            }
+        }
+    }
+    linkSize = limitVector.size();
+    nodeOffsetArray = nodeOffsetVector.data();
+    nodeLinkArray = nodeLinkVector.data();
+    kindArray = kindVector.data();
+    limitArray = limitVector.data();
+    rangeArray = rangeVector.data();
+    linkOffsetArray = linkOffsetVector.data();
+    linkNodeArray = linkNodeVector.data();
+}
+
+template<typename TNodeID, typename TLinkID>
+BasicEngine<TNodeID,TLinkID>::BasicEngine(const vector<BasicLink<TNodeID>>& links, TNodeID nodeSize)
+    : BasicEngine(std::make_shared<const BasicProblem<TNodeID,TLinkID>>(links, nodeSize)) {}
+
+template<typename TNodeID, typename TLinkID>
+BasicEngine<TNodeID,TLinkID>::BasicEngine(vector<BasicLink<TNodeID>>&& links, TNodeID nodeSize)
+    : BasicEngine(std::make_shared<const BasicProblem<TNodeID,TLinkID>>(std::move(links), nodeSize)) {}
+
+template<typename TNodeID, typename TLinkID>
+BasicEngine<TNodeID,TLinkID>::BasicEngine(std::shared_ptr<const BasicProblem<TNodeID,TLinkID>> problem)
+    : problem(std::move(problem)),
+      stateVector(BasicEngine::problem->nodeSize, MAYBE),
+      counterVector(),
+      changeVector(), changeStampVector(BasicEngine::problem->linkSize, 0),
+      changeMarkVector(stateVector.size(), 0), changeStamp(1),
+      addKindVector(), addRangeVector(), addLinkOffsetVector(), addLinkNodeVector(), addNodeLinkVector(),
+      nodeIDArray(std::make_unique<TNodeID[]>(stateVector.size())),
+      boundArray(std::make_unique<Bound[]>(stateVector.size() + 1)),
+      trueNodeIDPtrTop(nodeIDArray.get()), falseNodeIDPtrTop(nodeIDArray.get() + stateVector.size() - 1),
+      heuristic(ORDER), phaseSaving(false), phaseVector(),
+      activityHeap(), activityIncrement(1),
+      slackHeap(), slackParkVector(),
+      conflictLinkID(0),
+      restart(NEVER), restartUnit(100), restartIndex(0), restartLimit(0),
+      reasonVector(stateVector.size(), DECISION), levelVector(stateVector.size(), 0), orderVector(stateVector.size(), 0),
+      level(0), order(0),
+      learning(false), learnLimit(1 << 14), learnIncrement(1),
+      learnVector(), learnNodeVector(), watchVector(),
+      lazyVector(), lazyNodeVector(), lazyWatchVector(),
+      learnBuffer(), learnLevel(0),
+      seenVector(), seenNodeVector(), analyzeHeap(),
+      assumeVector(),
+      split(nullptr), splitPath(), splitDepth(0),
+      resumeDepth(NONE), resumePathVector(),
+      statistics()
+{
+    counterVector.reserve(BasicEngine::problem->linkSize);
+    for (TLinkID linkID = 0; linkID < BasicEngine::problem->linkSize; linkID++) {
+        const auto& [inLimit, outLimit] = BasicEngine::problem->limitArray[linkID];
+        counterVector.push_back({0, 0, inLimit, outLimit});
+    }
+    constrain_watch();
+}
+
+template<typename TNodeID, typename TLinkID>
+void BasicEngine<TNodeID,TLinkID>::setHeuristic(Heuristic heuristic, bool phaseSaving)
+{
+    assert(heuristic == ORDER || heuristic == SLACK || heuristic == ACTIVITY);
+    backtrack_abandon();
+    BasicEngine::heuristic = heuristic;
+    BasicEngine::phaseSaving = phaseSaving;
+    phaseVector = phaseSaving ? vector<State>(stateVector.size(), TRUE) : vector<State>();
+    activityHeap = Heap<TNodeID,double,std::greater<double>>();
+    activityIncrement = 1;
+    slackHeap = Heap<TLinkID,TNodeID>();
+    slackParkVector.clear();
+    if (heuristic == ACTIVITY) {
+        activityHeap = Heap<TNodeID,double,std::greater<double>>(stateVector.size(), 0);
+        for (TNodeID nodeID = 0; nodeID < stateVector.size(); nodeID++)
+            if (stateVector[nodeID] == MAYBE) activityHeap.push(nodeID);
+    } else if (heuristic == SLACK) {
+        // Lazy links keep no counts to rank them by
+        slackHeap = Heap<TLinkID,TNodeID>(counterVector.size(), 0);
+        for (TLinkID linkID = 0; linkID < counterVector.size(); linkID++) {
+            if (getLinkKind(linkID) == LAZY) continue;
+            backtrack_updateSlack(linkID);
+            slackHeap.push(linkID);
+        }
+    }
+}
+
+template<typename TNodeID, typename TLinkID>
+void BasicEngine<TNodeID,TLinkID>::setLearning(bool learning, TReasonID learnLimit)
+{
+    backtrack_abandon();
+    BasicEngine::learning = learning;
+    BasicEngine::learnLimit = learnLimit;
+    if (learning && watchVector.empty()) {
+        watchVector.resize(2 * stateVector.size());
+        seenVector.assign(stateVector.size(), false);
+    }
+}
+
+template<typename TNodeID, typename TLinkID>
+void BasicEngine<TNodeID,TLinkID>::setRestarts(Restart restart, TCount unit)
+{
+    assert(restart == NEVER || restart == LUBY || restart == GEOMETRIC);
+    BasicEngine::restart = restart;
+    restartUnit = std::max<TCount>(unit, 1);
+}
+
+template<typename TNodeID, typename TLinkID>
+void BasicEngine<TNodeID,TLinkID>::setLinkStatistics(bool enabled)
+{
+    // Only counted when built with IMPLY_STATISTICS
+    statistics.linkCountVector = vector<std::atomic<TCount>>(enabled ? counterVector.size() : 0);
+}
+
+template<typename TNodeID, typename TLinkID>
+bool BasicEngine<TNodeID,TLinkID>::addLink(const BasicLink<TNodeID>& link)
+{
+    return addLinks(&link, &link + 1);
+}
+
+template<typename TNodeID, typename TLinkID>
+bool BasicEngine<TNodeID,TLinkID>::addLinks(const vector<BasicLink<TNodeID>>& links)
+{
+    return addLinks(links.data(), links.data() + links.size());
+}
+
+template<typename TNodeID, typename TLinkID>
+bool BasicEngine<TNodeID,TLinkID>::addLinks(const BasicLink<TNodeID>* ptr, const BasicLink<TNodeID>* endPtr)
+{
+    // Only the new links' nodes are visited: their counters start from the states as they are
+    if (size_t(endPtr - ptr) >= size_t(TLinkID(~TLinkID(0))) - counterVector.size()) return false;
+    backtrack_abandon();
+    const TLinkID startLinkID = counterVector.size();
+    if (addNodeLinkVector.empty()) addNodeLinkVector.resize(2 * stateVector.size());
+    if (addLinkOffsetVector.empty()) addLinkOffsetVector.push_back(0);
+    for ( ; ptr < endPtr; ptr++) {
+        const BasicLink<TNodeID>& link = *ptr;
+        const TLinkID linkID = counterVector.size();
+        // [trueIn | falseIn | trueOut | falseOut], as in the problem
         const TNodeID* inPtr = link.inArray.get();
         const TNodeID* outPtr = link.outArray.get();
-        for (const TNodeID* trueInPtr = inPtr + link.trueInLen; inPtr < trueInPtr; inPtr++) {
-            Node& node = nodeVector[*inPtr];
-            node.trueArray[node.trueInLen++] = i;
-        }
-        for (const TNodeID* falseInPtr = inPtr + link.falseInLen; inPtr < falseInPtr; inPtr++) {
-            Node& node = nodeVector[*inPtr];
-            node.falseArray[node.falseInLen++] = i;
+        addLinkNodeVector.insert(addLinkNodeVector.end(), inPtr, inPtr + link.trueInLen);
+        addLinkOffsetVector.push_back(addLinkNodeVector.size());
+        addLinkNodeVector.insert(addLinkNodeVector.end(), inPtr + link.trueInLen, inPtr + link.trueInLen + link.falseInLen);
+        addLinkOffsetVector.push_back(addLinkNodeVector.size());
+        addLinkNodeVector.insert(addLinkNodeVector.end(), outPtr, outPtr + link.trueOutLen);
+        addLinkOffsetVector.push_back(addLinkNodeVector.size());
+        addLinkNodeVector.insert(addLinkNodeVector.end(), outPtr + link.trueOutLen, outPtr + link.trueOutLen + link.falseOutLen);
+        addLinkOffsetVector.push_back(addLinkNodeVector.size());
+        const TOffset* offsetPtr = addLinkOffsetVector.data() + addLinkOffsetVector.size() - 5;
+        addKindVector.push_back(link.kind);
+        addRangeVector.push_back(getRanges(addLinkNodeVector.data(), offsetPtr));
+        // Segments 0 and 2 count TRUE nodes, 1 and 3 FALSE nodes; a group counts
+        // its TRUE nodes as outCount and, for exactly one, its FALSE nodes as inCount
+        Counter counter {0, 0, link.inLimit, link.outLimit};
+        for (TOffset k = 0; k < 4; k++) {
+            for (TOffset i = offsetPtr[k]; i < offsetPtr[k + 1]; i++) {
+                const TNodeID nodeID = addLinkNodeVector[i];
+                assert(nodeID < stateVector.size());
+                const State nodeState = stateVector[nodeID];
+                if (link.kind == GENERIC) {
+                    const State countState = k % 2 == 0 ? TRUE : FALSE;
+                    const Side side = k < 2 ? IN : OUT;
+                    addNodeLinkVector[2 * nodeID + countState].push_back({linkID, side});
+                    if (nodeState == countState) (side == IN ? counter.inCount : counter.outCount)++;
+                    continue;
+                }
+                addNodeLinkVector[2 * nodeID + TRUE].push_back({linkID, GROUP});
+                if (nodeState == TRUE) counter.outCount++;
+                if (link.kind != EXACTLY_ONE) continue;
+                addNodeLinkVector[2 * nodeID + FALSE].push_back({linkID, GROUP});
+                if (nodeState == FALSE) counter.inCount++;
+            }
         }
-        for (const TNodeID* trueOutPtr = outPtr + link.trueOutLen; outPtr < trueOutPtr; outPtr++) {
-            Node& node = nodeVector[*outPtr];
-            node.trueArray[node.trueOutLen++] = i;
+        counterVector.push_back(counter);
+    }
+    const TLinkID linkSize = counterVector.size();
+    if (heuristic == SLACK) slackHeap.grow(linkSize, 0);
+    if (!learnVector.empty()) addLinks_shiftReasons(startLinkID, linkSize - startLinkID);
+
+    // Links already at their limits fire now, at level 0 like constrain
+    TNodeID* trueNodeIDPtrEnd = trueNodeIDPtrTop;
+    TNodeID* falseNodeIDPtrEnd = falseNodeIDPtrTop;
+    level = 0;
+    for (TLinkID linkID = startLinkID; linkID < linkSize; linkID++) {
+        if (!addLinks_fire(trueNodeIDPtrEnd, falseNodeIDPtrEnd, linkID)) {
+            undo(
+                trueNodeIDPtrTop, trueNodeIDPtrTop, trueNodeIDPtrEnd, 
+                falseNodeIDPtrTop, falseNodeIDPtrTop, falseNodeIDPtrEnd);
+            addLinks_remove(startLinkID);
+            return false;
         }
-        for (const TNodeID* falseOutPtr = outPtr + link.falseOutLen; outPtr < falseOutPtr; outPtr++) {
-            Node& node = nodeVector[*outPtr];
-            node.falseArray[node.falseOutLen++] = i;
+    }
+    if (!constrain(
+            trueNodeIDPtrTop, falseNodeIDPtrTop, 
+            trueNodeIDPtrEnd, falseNodeIDPtrEnd)) {
+        addLinks_remove(startLinkID);
+        return false;
+    }
+    trueNodeIDPtrTop = trueNodeIDPtrEnd;
+    falseNodeIDPtrTop = falseNodeIDPtrEnd;
+    if (heuristic == SLACK) {
+        for (TLinkID linkID = startLinkID; linkID < linkSize; linkID++) {
+            backtrack_updateSlack(linkID);
+            slackHeap.push(linkID);
         }
     }
-    // Indices to Lengths
-    for (Node& node : nodeVector) {
-        node.trueOutLen -= node.trueInLen;
-        node.falseOutLen -= node.falseInLen;
+    return true;
+}
+
+template<typename TNodeID, typename TLinkID>
+bool BasicEngine<TNodeID,TLinkID>::addLinks_fire(
+    TNodeID*& trueNodeIDPtrEnd, TNodeID*& falseNodeIDPtrEnd, 
+    const TLinkID linkID) noexcept
+{
+    // Counts that start at or past a limit never pass it in constrain, so check them once
+    const Counter& counter = counterVector[linkID];
+    const TNodeID* linkNodeArray = getLinkNodes(linkID);
+    const TOffset* offsetPtr = getLinkOffsets(linkID);
+    const unsigned char ranges = getLinkRanges(linkID);
+    bool consistent = true;
+    if (getLinkKind(linkID) == GENERIC) {
+        if (counter.inCount >= TNodeID(counter.inLimit + 1) && counter.outCount >= counter.outLimit)
+            consistent = constrain_updateNodeArray(
+                trueNodeIDPtrEnd, falseNodeIDPtrEnd, 
+                linkNodeArray + offsetPtr[2], linkNodeArray + offsetPtr[3], linkNodeArray + offsetPtr[4], 
+                counter.outLimit, ranges >> 2, linkID);
+        else if (counter.outCount >= TNodeID(counter.outLimit + 1) && counter.inCount >= counter.inLimit)
+            consistent = constrain_updateNodeArray(
+                trueNodeIDPtrEnd, falseNodeIDPtrEnd, 
+                linkNodeArray + offsetPtr[0], linkNodeArray + offsetPtr[1], linkNodeArray + offsetPtr[2], 
+                counter.inLimit, ranges & 0b11, linkID);
+    } else {
+        const TNodeID* ptr = linkNodeArray + offsetPtr[2];
+        const TNodeID* endPtr = linkNodeArray + offsetPtr[3];
+        const bool isRange = ranges & 0b100;
+        if (counter.outCount >= counter.outLimit)
+            consistent = constrain_updateNodeArray(
+                trueNodeIDPtrEnd, falseNodeIDPtrEnd, 
+                ptr, endPtr, endPtr, counter.outLimit, isRange ? 0b01 : 0, linkID);
+        else if (counter.inCount >= counter.inLimit)
+            consistent = constrain_updateNodeArray(
+                trueNodeIDPtrEnd, falseNodeIDPtrEnd, 
+                ptr, ptr, endPtr, counter.inLimit, isRange ? 0b10 : 0, linkID);
+    }
+    if (!consistent) {
+        conflictLinkID = linkID;
+        increment(statistics.conflictCount);
+    }
+    return consistent;
+}
+
+template<typename TNodeID, typename TLinkID>
+void BasicEngine<TNodeID,TLinkID>::addLinks_remove(const TLinkID linkID) noexcept
+{
+    // Links from linkID on were added last, so each literal's entries for them are last too
+    const TLinkID linkSize = counterVector.size();
+    const TOffset offset = getLinkOffsets(linkID)[0];
+    for (TOffset i = offset; i < addLinkNodeVector.size(); i++) {
+        for (const State state : {FALSE, TRUE}) {
+            vector<pair<TLinkID,Side>>& adds = addNodeLinkVector[2 * addLinkNodeVector[i] + state];
+            while (!adds.empty() && adds.back().first >= linkID) adds.pop_back();
+        }
     }
+    const TLinkID addSize = linkID - problem->linkSize;
+    addKindVector.resize(addSize);
+    addRangeVector.resize(addSize);
+    addLinkOffsetVector.resize(4 * addSize + 1);
+    addLinkNodeVector.resize(offset);
+    counterVector.resize(linkID);
+    if (!learnVector.empty()) addLinks_shiftReasons(linkSize, -(long long) (linkSize - linkID));
 }
 
-bool Engine::constrain(const vector<pair<TNodeID,bool>>& nodeStates) noexcept
+template<typename TNodeID, typename TLinkID>
+void BasicEngine<TNodeID,TLinkID>::addLinks_shiftReasons(const TLinkID linkID, const long long shift) noexcept
 {
-    TNodeID* trueNodeIDPtrStart = nodeIDArray.get();
-    TNodeID* falseNodeIDPtrStart = nodeIDArray.get() + nodeVector.size() - 1;
+    // Learned links are numbered after the links, so assigned nodes they forced follow them
+    auto shiftReason = [this, linkID, shift](const TNodeID nodeID) {
+        TReasonID& reasonID = reasonVector[nodeID];
+        if (reasonID != DECISION && reasonID >= linkID) reasonID += shift;
+    };
+    for (const TNodeID* ptr = nodeIDArray.get(); ptr < trueNodeIDPtrTop; ptr++)
+        shiftReason(*ptr);
+    for (const TNodeID* ptr = nodeIDArray.get() + stateVector.size() - 1; ptr > falseNodeIDPtrTop; ptr--)
+        shiftReason(*ptr);
+}
+
+template<typename TNodeID, typename TLinkID>
+bool BasicEngine<TNodeID,TLinkID>::constrain(const vector<pair<TNodeID,bool>>& nodeStates) noexcept
+{
+    backtrack_abandon();
+    TNodeID* trueNodeIDPtrStart = trueNodeIDPtrTop;
+    TNodeID* falseNodeIDPtrStart = falseNodeIDPtrTop;
     TNodeID* trueNodeIDPtrEnd = trueNodeIDPtrStart;
     TNodeID* falseNodeIDPtrEnd = falseNodeIDPtrStart;
+    level = 0;
     for (pair<TNodeID,bool> nodeState : nodeStates) {
         TNodeID nodeID = nodeState.first;
         bool state = nodeState.second;
-        assert(nodeID < nodeVector.size());
-
-        Node& node = nodeVector[nodeID];
-        assert(node.state == MAYBE);
-        if (state) {
-            node.state = TRUE;
-            *(trueNodeIDPtrEnd++) = nodeID;
-        } else {
-            node.state = FALSE;
-            *(falseNodeIDPtrEnd--) = nodeID;
-        }
+        assert(nodeID < stateVector.size());
+        assert(stateVector[nodeID] == MAYBE);
+        constrain_updateNode(
+            trueNodeIDPtrEnd, falseNodeIDPtrEnd, 
+            nodeID, state ? TRUE : FALSE, DECISION);
     }
-    return constrain(
-        trueNodeIDPtrStart, falseNodeIDPtrStart, 
-        trueNodeIDPtrEnd, falseNodeIDPtrEnd);
+    if (!constrain(
+            trueNodeIDPtrStart, falseNodeIDPtrStart, 
+            trueNodeIDPtrEnd, falseNodeIDPtrEnd)) return false;
+    trueNodeIDPtrTop = trueNodeIDPtrEnd;
+    falseNodeIDPtrTop = falseNodeIDPtrEnd;
+    return true;
 }
 
-bool Engine::constrain(const vector<TNodeID>& trueNodeIDs, const vector<TNodeID>& falseNodeIDs) noexcept
+template<typename TNodeID, typename TLinkID>
+bool BasicEngine<TNodeID,TLinkID>::constrain(const vector<TNodeID>& trueNodeIDs, const vector<TNodeID>& falseNodeIDs) noexcept
 {
-    TNodeID* trueNodeIDPtrStart = nodeIDArray.get();
-    TNodeID* falseNodeIDPtrStart = nodeIDArray.get() + nodeVector.size() - 1;
+    backtrack_abandon();
+    TNodeID* trueNodeIDPtrStart = trueNodeIDPtrTop;
+    TNodeID* falseNodeIDPtrStart = falseNodeIDPtrTop;
     TNodeID* trueNodeIDPtrEnd = trueNodeIDPtrStart;
     TNodeID* falseNodeIDPtrEnd = falseNodeIDPtrStart;
+    level = 0;
     for (TNodeID nodeID : trueNodeIDs) {
-        assert(nodeID < nodeVector.size());
-        Node& node = nodeVector[nodeID];
-        assert(node.state == MAYBE);
-        node.state = TRUE;
-        *(trueNodeIDPtrEnd++) = nodeID;
+        assert(nodeID < stateVector.size());
+        assert(stateVector[nodeID] == MAYBE);
+        constrain_updateNode(
+            trueNodeIDPtrEnd, falseNodeIDPtrEnd, 
+            nodeID, TRUE, DECISION);
     }
     for (TNodeID nodeID : falseNodeIDs) {
-        assert(nodeID < nodeVector.size());
-        Node& node = nodeVector[nodeID];
-        assert(node.state == MAYBE);
-        node.state = FALSE;
-        *(falseNodeIDPtrEnd--) = nodeID;
+        assert(nodeID < stateVector.size());
+        assert(stateVector[nodeID] == MAYBE);
+        constrain_updateNode(
+            trueNodeIDPtrEnd, falseNodeIDPtrEnd, 
+            nodeID, FALSE, DECISION);
     }
-    return constrain(
-        trueNodeIDPtrStart, falseNodeIDPtrStart, 
-        trueNodeIDPtrEnd, falseNodeIDPtrEnd);
+    if (!constrain(
+            trueNodeIDPtrStart, falseNodeIDPtrStart, 
+            trueNodeIDPtrEnd, falseNodeIDPtrEnd)) return false;
+    trueNodeIDPtrTop = trueNodeIDPtrEnd;
+    falseNodeIDPtrTop = falseNodeIDPtrEnd;
+    return true;
 }
 
-bool Engine::backtrack() noexcept
+template<typename TNodeID, typename TLinkID>
+bool BasicEngine<TNodeID,TLinkID>::backtrack() noexcept
 {
-    Bound* boundPtr = boundArray.get();
-    boundPtr->trueNodeIDPtr = nodeIDArray.get();
-    boundPtr->falseNodeIDPtr = nodeIDArray.get() + nodeVector.size() - 1;
-    boundPtr->state = TRUE;
+    TCount count = 0;
+    return backtrack(nullptr, 0, count) == SAT;
+}
+
+template<typename TNodeID, typename TLinkID>
+TCount BasicEngine<TNodeID,TLinkID>::enumerate(const TCallback& callback, const TCount limit)
+{
+    // Links learned while solutions are blocked only hold for this call
+    const TOrder startOrder = order;
+    TCount count = 0;
+    backtrack(&callback, limit, count);
+    backtrack_forget(startOrder);
+    return count;
+}
+
+template<typename TNodeID, typename TLinkID>
+TCount BasicEngine<TNodeID,TLinkID>::count(const TCount limit)
+{
+    return enumerate([](const vector<State>&) { return true; }, limit);
+}
+
+template<typename TNodeID, typename TLinkID>
+bool BasicEngine<TNodeID,TLinkID>::solveUnder(
+    const vector<pair<TNodeID,bool>>& assumptions, 
+    vector<pair<TNodeID,bool>>& core, vector<State>& model)
+{
+    // Assumptions the states already hold need no level and repeats are dropped;
+    // one the states rule out, or a node assumed both ways, is a core by itself
+    core.clear();
+    assumeVector.clear();
+    if (seenVector.empty()) seenVector.assign(stateVector.size(), false);
+    for (pair<TNodeID,bool> assumption : assumptions) {
+        const TNodeID nodeID = assumption.first;
+        const State state = assumption.second ? TRUE : FALSE;
+        assert(nodeID < stateVector.size());
+        if (stateVector[nodeID] == state) continue;
+        if (stateVector[nodeID] != MAYBE) {
+            core.assign(1, assumption);
+            break;
+        }
+        if (seenVector[nodeID]) {
+            if (std::find(assumeVector.cbegin(), assumeVector.cend(), 2 * nodeID + state) != assumeVector.cend()) continue;
+            core = {{nodeID, !assumption.second}, assumption};
+            break;
+        }
+        seenVector[nodeID] = true;
+        assumeVector.push_back(2 * nodeID + state);
+    }
+    for (TNodeID literal : assumeVector) seenVector[literal >> 1] = false;
+    if (!core.empty()) {
+        assumeVector.clear();
+        return false;
+    }
+
+    // Stop at the first solution; the search is undone either way
+    TCount count = 0;
+    const TCallback callback = [&model](const vector<State>& stateVector) {
+        model = stateVector;
+        return false;
+    };
+    const bool found = backtrack(&callback, 1, count) == SAT;
+    if (!found)
+        for (TNodeID literal : learnBuffer)
+            core.push_back({literal >> 1, (literal & 1) == TRUE});
+    assumeVector.clear();
+    return found;
+}
+
+template<typename TNodeID, typename TLinkID>
+bool BasicEngine<TNodeID,TLinkID>::probe(const unsigned int threadCount, const double seconds)
+{
+    typedef std::chrono::steady_clock Clock;
+    backtrack_abandon();
+    const Clock::time_point deadline = seconds > 0 ?
+        Clock::now() + std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(seconds)) :
+        Clock::time_point::max();
+    while (true) {
+        vector<pair<TNodeID,bool>> facts;
+        if (threadCount <= 1) {
+            if (!probe_round(0, 1, deadline, facts)) return false;
+        } else {
+            // Every finding holds under these states, so all of them can be fixed here
+            vector<BasicEngine> workerVector(threadCount, *this);
+            vector<vector<pair<TNodeID,bool>>> factsVector(threadCount);
+            std::unique_ptr<bool[]> consistents = std::make_unique<bool[]>(threadCount);
+            vector<std::thread> threadVector;
+            threadVector.reserve(threadCount);
+            for (unsigned int i = 0; i < threadCount; i++) {
+                threadVector.emplace_back([&, i]() {
+                    consistents[i] = workerVector[i].probe_round(i, threadCount, deadline, factsVector[i]); });
+            }
+            for (std::thread& thread : threadVector) thread.join();
+            const Statistics base = statistics;
+            for (const BasicEngine& worker : workerVector) statistics.add(worker.statistics, base);
+            for (unsigned int i = 0; i < threadCount; i++) {
+                if (!consistents[i]) return false;
+                facts.insert(facts.end(), factsVector[i].cbegin(), factsVector[i].cend());
+            }
+            if (!probe_fix(facts.data(), facts.data() + facts.size())) return false;
+        }
+        if (facts.empty() || Clock::now() >= deadline) return true;
+    }
+}
+
+template<typename TNodeID, typename TLinkID>
+bool BasicEngine<TNodeID,TLinkID>::probe_round(
+    TNodeID nodeID, const TNodeID step, const std::chrono::steady_clock::time_point deadline, 
+    vector<pair<TNodeID,bool>>& facts) noexcept
+{
+    // Both sides are always probed: a side that must hold still carries the
+    // assignments the other side is compared against
+    vector<State> probeVector(stateVector.size(), MAYBE);
+    vector<TNodeID> probeNodeIDs;
+    auto probeNode = [this](const TNodeID nodeID, const State state, const auto& visit) {
+        TNodeID* trueNodeIDPtrEnd = trueNodeIDPtrTop;
+        TNodeID* falseNodeIDPtrEnd = falseNodeIDPtrTop;
+        constrain_updateNode(
+            trueNodeIDPtrEnd, falseNodeIDPtrEnd, 
+            nodeID, state, DECISION);
+        if (!constrain(trueNodeIDPtrTop, falseNodeIDPtrTop, trueNodeIDPtrEnd, falseNodeIDPtrEnd)) return false;
+        for (const TNodeID* ptr = trueNodeIDPtrTop; ptr < trueNodeIDPtrEnd; ptr++) visit(*ptr, TRUE);
+        for (const TNodeID* ptr = falseNodeIDPtrTop; ptr > falseNodeIDPtrEnd; ptr--) visit(*ptr, FALSE);
+        undo(
+            trueNodeIDPtrTop, trueNodeIDPtrEnd, trueNodeIDPtrEnd, 
+            falseNodeIDPtrTop, falseNodeIDPtrEnd, falseNodeIDPtrEnd);
+        return true;
+    };
+    level = 0;
+    for ( ; nodeID < stateVector.size(); nodeID += step) {
+        if (stateVector[nodeID] != MAYBE) continue;
+        if (std::chrono::steady_clock::now() >= deadline) break;
+        const size_t factSize = facts.size();
+        const bool trueHeld = probeNode(nodeID, TRUE, [&](const TNodeID otherID, const State state) {
+            probeVector[otherID] = state;
+            probeNodeIDs.push_back(otherID);
+        });
+        const bool falseHeld = probeNode(nodeID, FALSE, [&](const TNodeID otherID, const State state) {
+            if (otherID != nodeID && probeVector[otherID] == state) facts.push_back({otherID, state == TRUE});
+        });
+        for (const TNodeID otherID : probeNodeIDs) probeVector[otherID] = MAYBE;
+        probeNodeIDs.clear();
+        if (!trueHeld && !falseHeld) return false;
+        if (!trueHeld) facts.push_back({nodeID, false});
+        if (!falseHeld) facts.push_back({nodeID, true});
+        if (!probe_fix(facts.data() + factSize, facts.data() + facts.size())) return false;
+    }
+    return true;
+}
+
+template<typename TNodeID, typename TLinkID>
+bool BasicEngine<TNodeID,TLinkID>::probe_fix(const pair<TNodeID,bool>* ptr, const pair<TNodeID,bool>* endPtr) noexcept
+{
+    // Findings may overlap or have been fixed since; one opposite a state means no solution
+    TNodeID* trueNodeIDPtrEnd = trueNodeIDPtrTop;
+    TNodeID* falseNodeIDPtrEnd = falseNodeIDPtrTop;
+    level = 0;
+    for ( ; ptr < endPtr; ptr++) {
+        if (!constrain_updateNode(
+                trueNodeIDPtrEnd, falseNodeIDPtrEnd, 
+                ptr->first, ptr->second ? TRUE : FALSE, DECISION)) {
+            undo(
+                trueNodeIDPtrTop, trueNodeIDPtrTop, trueNodeIDPtrEnd, 
+                falseNodeIDPtrTop, falseNodeIDPtrTop, falseNodeIDPtrEnd);
+            return false;
+        }
+    }
+    if (!constrain(
+            trueNodeIDPtrTop, falseNodeIDPtrTop, 
+            trueNodeIDPtrEnd, falseNodeIDPtrEnd)) return false;
+    trueNodeIDPtrTop = trueNodeIDPtrEnd;
+    falseNodeIDPtrTop = falseNodeIDPtrEnd;
+    return true;
+}
+
+template<typename TNodeID, typename TLinkID>
+typename BasicEngine<TNodeID,TLinkID>::Checkpoint BasicEngine<TNodeID,TLinkID>::checkpoint() const noexcept
+{
+    const TNodeID* falseNodeIDPtrStart = nodeIDArray.get() + stateVector.size() - 1;
+    return {
+        (TNodeID) (trueNodeIDPtrTop - nodeIDArray.get()), 
+        (TNodeID) (falseNodeIDPtrStart - falseNodeIDPtrTop), 
+        order};
+}
+
+template<typename TNodeID, typename TLinkID>
+void BasicEngine<TNodeID,TLinkID>::rollback(const Checkpoint& checkpoint) noexcept
+{
+    // Only the trail above the checkpoint is visited
+    backtrack_abandon();
+    TNodeID* trueNodeIDPtr = nodeIDArray.get() + checkpoint.trueSize;
+    TNodeID* falseNodeIDPtr = nodeIDArray.get() + stateVector.size() - 1 - checkpoint.falseSize;
+    assert(trueNodeIDPtr <= trueNodeIDPtrTop && falseNodeIDPtr >= falseNodeIDPtrTop);
+    undo(
+        trueNodeIDPtr, trueNodeIDPtrTop, trueNodeIDPtrTop, 
+        falseNodeIDPtr, falseNodeIDPtrTop, falseNodeIDPtrTop);
+    trueNodeIDPtrTop = trueNodeIDPtr;
+    falseNodeIDPtrTop = falseNodeIDPtr;
+    backtrack_forget(checkpoint.order);
+    if (heuristic == SLACK) backtrack_unpark(0);
+}
+
+template<typename TNodeID, typename TLinkID>
+void BasicEngine<TNodeID,TLinkID>::reset() noexcept
+{
+    rollback({0, 0, 0});
+}
 
+template<typename TNodeID, typename TLinkID>
+Result BasicEngine<TNodeID,TLinkID>::backtrack(const TCallback* callback, const TCount limit, TCount& count, const Budget* budget)
+{
+    Bound* boundPtr = boundArray.get();
     TNodeID nodeID = 0;
+    State nodeState = TRUE;
+    if (budget != nullptr && resumeDepth != NONE) {
+        // Back to the bound a limit stopped at; it kept the node to search on from
+        boundPtr += resumeDepth;
+        nodeID = boundPtr->nodeID;
+        resumeDepth = NONE;
+    } else {
+        backtrack_abandon();
+        *boundPtr = Bound(trueNodeIDPtrTop, falseNodeIDPtrTop, TRUE);
+        if (heuristic == SLACK) backtrack_unpark(0);
+        restartIndex = 0;
+        backtrack_schedule();
+    }
+    unsigned int pollCount = 0;
+    // Restarting a chronological search would forget solutions reported and branches given away
+    const bool restarting = restart != NEVER && (learning || (callback == nullptr && split == nullptr));
 
     while (true) {
         TNodeID* trueNodeIDPtrStart = boundPtr->trueNodeIDPtr;
         TNodeID* falseNodeIDPtrStart = boundPtr->falseNodeIDPtr;
-        TNodeID* trueNodeIDPtrEnd;
-        TNodeID* falseNodeIDPtrEnd;
+        TNodeID* trueNodeIDPtrEnd = trueNodeIDPtrStart;
+        TNodeID* falseNodeIDPtrEnd = falseNodeIDPtrStart;
+        level = boundPtr - boundArray.get() + 1;
 
         switch (boundPtr->state) {
         case TRUE: 
-            if (!backtrack_findMaybe(nodeID)) return true;
-            *trueNodeIDPtrStart = nodeID;
-            nodeVector[nodeID].state = TRUE;
+            if (split != nullptr) {
+                const Bound* splitPtr = boundPtr;
+                if (!backtrack_split(boundPtr, nodeID)) {
+                    backtrack_clear(boundPtr);
+                    return UNSAT;
+                }
+                if (boundPtr != splitPtr) continue;
+            }
+            if (budget != nullptr && budget->isOver(
+                    statistics.decisionCount.load(std::memory_order_relaxed), 
+                    statistics.conflictCount.load(std::memory_order_relaxed), 
+                    (pollCount++ & 63) == 0)) {
+                // Suspend: the bound keeps the node to search on from for the next solve
+                boundPtr->nodeID = nodeID;
+                resumeDepth = boundPtr - boundArray.get();
+                return UNKNOWN;
+            }
+            if (restarting && statistics.conflictCount.load(std::memory_order_relaxed) >= restartLimit &&
+                TNodeID(boundPtr - boundArray.get()) > assumeVector.size()) {
+                backtrack_restart(boundPtr, nodeID);
+                continue;
+            }
+            if (TNodeID(boundPtr - boundArray.get()) < assumeVector.size()) {
+                if (!backtrack_assume(boundPtr, nodeID)) {
+                    backtrack_clear(boundPtr);
+                    return UNSAT;
+                }
+                continue;
+            }
+            if (!backtrack_findMaybe(nodeID, nodeState, boundPtr - boundArray.get())) {
+                if (callback == nullptr) {
+                    backtrack_commit(boundPtr);
+                    return SAT;
+                }
+                // Enumerate: report the solution, then search on as if it failed
+                const bool more = (*callback)(stateVector);
+                if (++count == limit || !more) {
+                    backtrack_clear(boundPtr);
+                    return SAT;
+                }
+                if (!learning) {
+                    boundPtr->state = MAYBE;
+                    continue;
+                }
+                if (!backtrack_block(boundPtr, nodeID)) {
+                    backtrack_clear(boundPtr);
+                    return UNSAT;
+                }
+                continue;
+            }
+            increment(statistics.decisionCount);
+            boundPtr->nodeID = nodeID;
+            boundPtr->nodeState = nodeState;
+            constrain_updateNode(
+                trueNodeIDPtrEnd, falseNodeIDPtrEnd, 
+                nodeID, nodeState, DECISION);
 
-            trueNodeIDPtrEnd = trueNodeIDPtrStart + 1;
-            falseNodeIDPtrEnd = falseNodeIDPtrStart;
             if (constrain(trueNodeIDPtrStart, falseNodeIDPtrStart, trueNodeIDPtrEnd, falseNodeIDPtrEnd)) {
                 boundPtr->state = FALSE;
                 *(++boundPtr) = Bound(trueNodeIDPtrEnd, falseNodeIDPtrEnd, TRUE);
+                if constexpr (STATISTICS) raise(statistics.maxBoundDepth, boundPtr - boundArray.get());
                 continue;
             }
+            if (learning) {
+                if (backtrack_learn(boundPtr, nodeID)) continue;
+                backtrack_clear(boundPtr);
+                return UNSAT;
+            }
+            if (heuristic == ACTIVITY) backtrack_bump(conflictLinkID);
+            trueNodeIDPtrEnd = trueNodeIDPtrStart;
+            falseNodeIDPtrEnd = falseNodeIDPtrStart;
         case FALSE:
-            nodeID = *trueNodeIDPtrStart;
-            *falseNodeIDPtrStart = nodeID;
-            nodeVector[nodeID].state = FALSE;
+            nodeID = boundPtr->nodeID;
+            nodeState = 1 - boundPtr->nodeState;
+            constrain_updateNode(
+                trueNodeIDPtrEnd, falseNodeIDPtrEnd, 
+                nodeID, nodeState, DECISION);
 
-            trueNodeIDPtrEnd = trueNodeIDPtrStart;
-            falseNodeIDPtrEnd = falseNodeIDPtrStart - 1;
             if (constrain(trueNodeIDPtrStart, falseNodeIDPtrStart, trueNodeIDPtrEnd, falseNodeIDPtrEnd)) {
                 boundPtr->state = MAYBE;
                 *(++boundPtr) = Bound(trueNodeIDPtrEnd, falseNodeIDPtrEnd, TRUE);
+                if constexpr (STATISTICS) raise(statistics.maxBoundDepth, boundPtr - boundArray.get());
                 continue;
             }
+            if (heuristic == ACTIVITY) backtrack_bump(conflictLinkID);
         case MAYBE:
-            if (boundPtr <= boundArray.get()) return false;
+            if (TNodeID(boundPtr - boundArray.get()) <= assumeVector.size()) {
+                // Nothing left below the assumptions decided so far
+                learnBuffer.assign(assumeVector.cbegin(), assumeVector.cbegin() + (boundPtr - boundArray.get()));
+                backtrack_clear(boundPtr);
+                return UNSAT;
+            }
             boundPtr--;
             undo(
                 boundPtr->trueNodeIDPtr, trueNodeIDPtrStart, trueNodeIDPtrStart,
                 boundPtr->falseNodeIDPtr, falseNodeIDPtrStart, falseNodeIDPtrStart);
+            if (heuristic == SLACK) backtrack_unpark(boundPtr - boundArray.get() + 1);
         }
     }
 }
 
-bool Engine::backtrack_findMaybe(TNodeID& nodeID) noexcept
+template<typename TNodeID, typename TLinkID>
+bool BasicEngine<TNodeID,TLinkID>::backtrack(const unsigned int threadCount)
 {
-    for ( ; nodeID < nodeVector.size(); nodeID++)
-        if (nodeVector[nodeID].state == MAYBE) return true;
-    return false;
+    if (threadCount <= 1) return backtrack();
+    backtrack_abandon();
+    resumePathVector.push_back({});
+    const Budget budget = {std::chrono::steady_clock::time_point::max(), ~TCount(0), ~TCount(0), nullptr};
+    return backtrack(threadCount, budget) == SAT;
 }
 
-bool Engine::constrain(
-    TNodeID* trueNodeIDPtrStart, TNodeID* falseNodeIDPtrStart, 
-    TNodeID*& trueNodeIDPtrEnd, TNodeID*& falseNodeIDPtrEnd) noexcept
+template<typename TNodeID, typename TLinkID>
+Result BasicEngine<TNodeID,TLinkID>::solve(const Limits& limits, const unsigned int threadCount)
 {
-    TNodeID* trueNodeIDPtr = trueNodeIDPtrStart;
-    TNodeID* falseNodeIDPtr = falseNodeIDPtrStart;
+    const TCount decisionCount = statistics.decisionCount.load(std::memory_order_relaxed);
+    const TCount conflictCount = statistics.conflictCount.load(std::memory_order_relaxed);
+    const Budget budget = {
+        limits.deadline,
+        limits.decisionBudget != 0 ? decisionCount + limits.decisionBudget : ~TCount(0),
+        limits.conflictBudget != 0 ? conflictCount + limits.conflictBudget : ~TCount(0),
+        limits.cancel};
+    if (threadCount <= 1 && resumePathVector.empty()) {
+        TCount count = 0;
+        return backtrack(nullptr, 0, count, &budget);
+    }
+    // Threads take over what a suspended search left as subproblems
+    if (resumeDepth != NONE) {
+        backtrack_open(boundArray.get() + resumeDepth, resumePathVector);
+        backtrack_clear(boundArray.get() + resumeDepth);
+        resumeDepth = NONE;
+    } else if (resumePathVector.empty()) {
+        resumePathVector.push_back({});
+    }
+    return backtrack(threadCount, budget);
+}
 
-    while (true) {
-        for ( ; trueNodeIDPtr < trueNodeIDPtrEnd; trueNodeIDPtr++) {
-            if (!constrain_updateLinkArray(
-                    trueNodeIDPtrEnd, falseNodeIDPtrEnd, 
-                    nodeVector[*trueNodeIDPtr], TRUE, false, true)) {
-                undo(
-                    trueNodeIDPtrStart, trueNodeIDPtr + 1, trueNodeIDPtrEnd, 
-                    falseNodeIDPtrStart, falseNodeIDPtr, falseNodeIDPtrEnd);
-                return false;
-            }
+template<typename TNodeID, typename TLinkID>
+Result BasicEngine<TNodeID,TLinkID>::backtrack(const unsigned int threadCount, const Budget& budget)
+{
+    // Each worker searches a fork of this engine; idle workers are fed by
+    // busy ones splitting off the shallowest open branch of their bound stack.
+    // Subproblems to search start in resumePathVector.
+    if (budget.isOver(statistics.decisionCount, statistics.conflictCount, true)) return UNKNOWN;
+    Split shared;
+    shared.pathVector = std::move(resumePathVector);
+    resumePathVector.clear();
+    vector<BasicEngine> workerVector(threadCount, *this);
+    vector<std::thread> threadVector;
+    threadVector.reserve(threadCount);
+    for (BasicEngine& worker : workerVector) {
+        worker.split = &shared;
+        threadVector.emplace_back(&BasicEngine::backtrack_work, &worker, std::cref(*this));
+    }
+    // Workers start from this engine's counters, and what each counted since the
+    // last merge is added to them as the search runs, so they can be read live.
+    // Live merges read the workers' relaxed counters outside the split lock and
+    // leave the link counts, O(links) a worker, to the merge after the join.
+    vector<Statistics> mergedVector(threadCount, statistics);
+    auto merge = [this, &workerVector, &mergedVector](const bool links) {
+        for (unsigned int i = 0; i < workerVector.size(); i++) {
+            Statistics copy;
+            if (links) copy = workerVector[i].statistics;
+            else       copy.assignCounts(workerVector[i].statistics);
+            statistics.add(copy, mergedVector[i]);
+            mergedVector[i].assignCounts(copy);
         }
-        if (!(falseNodeIDPtr > falseNodeIDPtrEnd)) return true;
-
-        for ( ; falseNodeIDPtr > falseNodeIDPtrEnd; falseNodeIDPtr--) {
-            if (!constrain_updateLinkArray(
-                    trueNodeIDPtrEnd, falseNodeIDPtrEnd, 
-                    nodeVector[*falseNodeIDPtr], FALSE, false, true)) {
-                undo(
-                    trueNodeIDPtrStart, trueNodeIDPtr, trueNodeIDPtrEnd, 
-                    falseNodeIDPtrStart, falseNodeIDPtr - 1, falseNodeIDPtrEnd);
-                return false;
+    };
+    {
+        std::unique_lock<std::mutex> lock(shared.mutex);
+        for ( ; shared.exitCount < threadCount; shared.exitCondition.wait_for(lock, std::chrono::milliseconds(1))) {
+            if (shared.stop) continue;
+            lock.unlock();
+            merge(false);
+            const bool over = budget.isOver(statistics.decisionCount, statistics.conflictCount, true);
+            lock.lock();
+            if (over) {
+                shared.limited = true;
+                shared.stop = true;
+                shared.condition.notify_all();
             }
         }
-        if (!(trueNodeIDPtr < trueNodeIDPtrEnd)) return true;
     }
+    for (std::thread& thread : threadVector) thread.join();
+    merge(true);
+    if (shared.solution == nullptr) {
+        if (!shared.limited) return UNSAT;
+        resumePathVector = std::move(shared.pathVector);
+        return UNKNOWN;
+    }
+    // Replay the model; learned links of the workers only hold under their subproblems
+    vector<pair<TNodeID,bool>> nodeStates;
+    for (TNodeID nodeID = 0; nodeID < stateVector.size(); nodeID++)
+        if (stateVector[nodeID] == MAYBE)
+            nodeStates.push_back({nodeID, shared.solution->stateVector[nodeID] == TRUE});
+    return constrain(nodeStates) ? SAT : UNSAT;
 }
 
-void Engine::undo(
-    TNodeID* trueNodeIDPtrStart, TNodeID* trueNodeIDPtrMid, TNodeID* trueNodeIDPtrEnd,
-    TNodeID* falseNodeIDPtrStart, TNodeID* falseNodeIDPtrMid, TNodeID* falseNodeIDPtrEnd) noexcept
+template<typename TNodeID, typename TLinkID>
+void BasicEngine<TNodeID,TLinkID>::backtrack_clear(const Bound* boundPtr) noexcept
 {
-    for ( ; trueNodeIDPtrStart < trueNodeIDPtrMid; trueNodeIDPtrStart++) {
-        Node& node = nodeVector[*trueNodeIDPtrStart];
-        node.state = MAYBE;
-        constrain_updateLinkArray(
-            trueNodeIDPtrEnd, falseNodeIDPtrEnd, 
-            node, TRUE, true, false);
-    }
-    for ( ; trueNodeIDPtrStart < trueNodeIDPtrEnd; trueNodeIDPtrStart++)
-        nodeVector[*trueNodeIDPtrStart].state = MAYBE;
+    // Undo the whole search, including nodes it fixed at level 0
+    undo(
+        trueNodeIDPtrTop, boundPtr->trueNodeIDPtr, boundPtr->trueNodeIDPtr,
+        falseNodeIDPtrTop, boundPtr->falseNodeIDPtr, boundPtr->falseNodeIDPtr);
+    if (heuristic == SLACK) backtrack_unpark(0);
+}
 
-    for ( ; falseNodeIDPtrStart > falseNodeIDPtrMid; falseNodeIDPtrStart--) {
-        Node& node = nodeVector[*falseNodeIDPtrStart];
-        node.state = MAYBE;
-        constrain_updateLinkArray(
-            trueNodeIDPtrEnd, falseNodeIDPtrEnd, 
-            node, FALSE, true, false);
+template<typename TNodeID, typename TLinkID>
+void BasicEngine<TNodeID,TLinkID>::backtrack_abandon() noexcept
+{
+    resumePathVector.clear();
+    if (resumeDepth == NONE) return;
+    backtrack_clear(boundArray.get() + resumeDepth);
+    resumeDepth = NONE;
+}
+
+template<typename TNodeID, typename TLinkID>
+void BasicEngine<TNodeID,TLinkID>::backtrack_open(const Bound* boundPtr, vector<vector<pair<TNodeID,bool>>>& pathVector) const
+{
+    // What a search below boundPtr has left: everything under its decisions so far,
+    // and the other side of each decision not yet flipped. Learned links may undo
+    // any decision, so with learning that is the whole subproblem.
+    vector<pair<TNodeID,bool>> path(splitPath);
+    if (!learning) {
+        for (const Bound* ptr = boundArray.get(); ptr < boundPtr; ptr++) {
+            if (ptr->state == FALSE) {
+                pathVector.push_back(path);
+                pathVector.back().push_back({ptr->nodeID, ptr->nodeState != TRUE});
+            }
+            path.push_back({ptr->nodeID, stateVector[ptr->nodeID] == TRUE});
+        }
     }
-    for ( ; falseNodeIDPtrStart > falseNodeIDPtrEnd; falseNodeIDPtrStart--)
-        nodeVector[*falseNodeIDPtrStart].state = MAYBE;
+    pathVector.push_back(std::move(path));
 }
 
-bool Engine::constrain_updateLinkArray(
-    TNodeID*& trueNodeIDPtrEnd, TNodeID*& falseNodeIDPtrEnd, 
-    const Node& node, const State state, const bool reset, const bool propagate) noexcept
+template<typename TNodeID, typename TLinkID>
+bool BasicEngine<TNodeID,TLinkID>::backtrack_block(Bound*& boundPtr, TNodeID& nodeID) noexcept
 {
-    assert(state == TRUE || state == FALSE);
-    if (state == TRUE)
-        return constrain_updateLinkArray(
-            trueNodeIDPtrEnd, falseNodeIDPtrEnd, 
-            node.trueArray, node.trueInLen, node.trueOutLen, reset, propagate);
-    else
-        return constrain_updateLinkArray(
-            trueNodeIDPtrEnd, falseNodeIDPtrEnd, 
-            node.falseArray, node.falseInLen, node.falseOutLen, reset, propagate);
+    // Exclude the solution with a learned link over its decisions, deepest first;
+    // zero glue keeps it through reductions
+    const TNodeID depth = boundPtr - boundArray.get();
+    if (depth == 0) return false;
+    learnBuffer.clear();
+    for (TNodeID i = depth; i > 0; i--)
+        learnBuffer.push_back(2 * boundArray[i - 1].nodeID + (1 - boundArray[i - 1].nodeState));
+    learnLevel = depth - 1;
+    backtrack_jump(boundPtr, nodeID, learnLevel);
+    const TReasonID reasonID = backtrack_store();
+    if (reasonID != DECISION) learnVector[reasonID - counterVector.size()].glue = 0;
+    if (backtrack_assert(boundPtr, nodeID, learnBuffer.front(), reasonID)) return true;
+    return backtrack_learn(boundPtr, nodeID);
 }
 
-bool Engine::constrain_updateLinkArray(
-    TNodeID*& trueNodeIDPtrEnd, TNodeID*& falseNodeIDPtrEnd, 
-    const unique_ptr<TLinkID[]>& nodeArray, const TLinkID inLen, const TLinkID outLen, const bool reset, const bool propagate) noexcept
+template<typename TNodeID, typename TLinkID>
+bool BasicEngine<TNodeID,TLinkID>::backtrack_findMaybe(TNodeID& nodeID, State& nodeState, const TNodeID depth) noexcept
 {
-    TLinkID* ptr = nodeArray.get();
-    for (TLinkID* inPtr = ptr + inLen; ptr < inPtr; ptr++)
-        if (!constrain_updateLink(
+    bool found;
+    nodeState = TRUE;
+    switch (heuristic) {
+    case SLACK:    found = backtrack_findSlack(nodeID, nodeState, depth); break;
+    case ACTIVITY: found = backtrack_findActivity(nodeID); break;
+    default:       found = backtrack_findOrder(nodeID); break;
+    }
+    if (found && phaseSaving) nodeState = phaseVector[nodeID];
+    return found;
+}
+
+template<typename TNodeID, typename TLinkID>
+bool BasicEngine<TNodeID,TLinkID>::backtrack_findOrder(TNodeID& nodeID) noexcept
+{
+    for ( ; nodeID < stateVector.size(); nodeID++)
+        if (stateVector[nodeID] == MAYBE) return true;
+    return false;
+}
+
+template<typename TNodeID, typename TLinkID>
+bool BasicEngine<TNodeID,TLinkID>::backtrack_findActivity(TNodeID& nodeID) noexcept
+{
+    // Assigned nodes leave the heap lazily and return on undo
+    while (!activityHeap.empty()) {
+        nodeID = activityHeap.pop();
+        if (stateVector[nodeID] == MAYBE) return true;
+    }
+    return false;
+}
+
+template<typename TNodeID, typename TLinkID>
+bool BasicEngine<TNodeID,TLinkID>::backtrack_findSlack(TNodeID& nodeID, State& nodeState, const TNodeID depth) noexcept
+{
+    // Links with no MAYBE node left are parked until the search unwinds past this depth
+    while (!slackHeap.empty()) {
+        const TLinkID linkID = slackHeap.top();
+        const Counter& counter = counterVector[linkID];
+        const TOffset* offsetPtr = getLinkOffsets(linkID);
+        const TNodeID* linkNodeArray = getLinkNodes(linkID);
+        // Branch on the side still needed for the link to fire
+        const bool isInActive = counter.inCount >= TNodeID(counter.inLimit + 1);
+        const TOffset firstOffset = isInActive ? 2 : 0;
+        const TOffset secondOffset = isInActive ? 0 : 2;
+        if (backtrack_findSlack(nodeID, nodeState, linkNodeArray,
+                offsetPtr[firstOffset], offsetPtr[firstOffset + 1], offsetPtr[firstOffset + 2]) ||
+            backtrack_findSlack(nodeID, nodeState, linkNodeArray,
+                offsetPtr[secondOffset], offsetPtr[secondOffset + 1], offsetPtr[secondOffset + 2]))
+            return true;
+        slackParkVector.push_back({slackHeap.pop(), depth});
+    }
+    // Nodes outside every link
+    nodeID = 0;
+    return backtrack_findOrder(nodeID);
+}
+
+template<typename TNodeID, typename TLinkID>
+bool BasicEngine<TNodeID,TLinkID>::backtrack_findSlack(
+    TNodeID& nodeID, State& nodeState, const TNodeID* linkNodeArray,
+    const TOffset offset, const TOffset midOffset, const TOffset endOffset) const noexcept
+{
+    // Prefer the state that counts towards the limit
+    for (TOffset i = offset; i < endOffset; i++) {
+        if (stateVector[linkNodeArray[i]] == MAYBE) {
+            nodeID = linkNodeArray[i];
+            nodeState = i < midOffset ? TRUE : FALSE;
+            return true;
+        }
+    }
+    return false;
+}
+
+template<typename TNodeID, typename TLinkID>
+void BasicEngine<TNodeID,TLinkID>::backtrack_unpark(const TNodeID depth) noexcept
+{
+    while (!slackParkVector.empty() && slackParkVector.back().second >= depth) {
+        slackHeap.push(slackParkVector.back().first);
+        slackParkVector.pop_back();
+    }
+}
+
+template<typename TNodeID, typename TLinkID>
+void BasicEngine<TNodeID,TLinkID>::backtrack_bump(const TLinkID linkID) noexcept
+{
+    const TOffset* offsetPtr = getLinkOffsets(linkID);
+    const TNodeID* ptr = getLinkNodes(linkID) + offsetPtr[0];
+    const TNodeID* endPtr = getLinkNodes(linkID) + offsetPtr[4];
+    for ( ; ptr < endPtr; ptr++)
+        backtrack_bumpNode(*ptr);
+    activityIncrement /= 0.95;
+}
+
+template<typename TNodeID, typename TLinkID>
+void BasicEngine<TNodeID,TLinkID>::backtrack_bumpNode(const TNodeID nodeID) noexcept
+{
+    double activity = activityHeap.getKey(nodeID) + activityIncrement;
+    activityHeap.update(nodeID, activity);
+    if (activity > 1e100) {
+        activityHeap.scale(1e-100);
+        activityIncrement *= 1e-100;
+    }
+}
+
+template<typename TNodeID, typename TLinkID>
+void BasicEngine<TNodeID,TLinkID>::backtrack_updateSlack(const TLinkID linkID) noexcept
+{
+    const Counter& counter = counterVector[linkID];
+    slackHeap.update(linkID, getLinkKind(linkID) == GENERIC ? counter.getSlack() : counter.getGroupSlack());
+}
+
+template<typename TNodeID, typename TLinkID>
+void BasicEngine<TNodeID,TLinkID>::backtrack_commit(const Bound* boundPtr) noexcept
+{
+    // A found assignment is final; later searches must see it as level 0
+    for ( ; trueNodeIDPtrTop < boundPtr->trueNodeIDPtr; trueNodeIDPtrTop++)
+        levelVector[*trueNodeIDPtrTop] = 0;
+    for ( ; falseNodeIDPtrTop > boundPtr->falseNodeIDPtr; falseNodeIDPtrTop--)
+        levelVector[*falseNodeIDPtrTop] = 0;
+    level = 0;
+}
+
+template<typename TNodeID, typename TLinkID>
+void BasicEngine<TNodeID,TLinkID>::backtrack_restart(Bound*& boundPtr, TNodeID& nodeID) noexcept
+{
+    // Back to the first bound past the assumptions, decided afresh; nodes fixed
+    // there by learned links stay
+    backtrack_jump(boundPtr, nodeID, assumeVector.size());
+    *boundPtr = Bound(boundPtr->trueNodeIDPtr, boundPtr->falseNodeIDPtr, TRUE);
+    nodeID = 0;
+    increment(statistics.restartCount);
+    restartIndex++;
+    backtrack_schedule();
+}
+
+template<typename TNodeID, typename TLinkID>
+void BasicEngine<TNodeID,TLinkID>::backtrack_schedule() noexcept
+{
+    // Luby: term restartIndex of 1, 1, 2, 1, 1, 2, 4, ..., found by descending from
+    // the smallest complete run of terms that holds it into the half that does
+    TCount units = 1;
+    if (restart == LUBY) {
+        TCount size = 1, index = restartIndex;
+        for ( ; size < index + 1; size = 2 * size + 1) units *= 2;
+        while (size - 1 != index) {
+            size = (size - 1) >> 1;
+            units >>= 1;
+            index %= size;
+        }
+    } else if (restart == GEOMETRIC) {
+        units = TCount(std::pow(1.5, restartIndex));
+    }
+    restartLimit = statistics.conflictCount.load(std::memory_order_relaxed) + restartUnit * units;
+}
+
+template<typename TNodeID, typename TLinkID>
+bool BasicEngine<TNodeID,TLinkID>::backtrack_assume(Bound*& boundPtr, TNodeID& nodeID) noexcept
+{
+    // Each assumption takes one level, empty if earlier ones imply it, and is
+    // never flipped; one they rule out leaves the core in learnBuffer. The
+    // search after them starts over from the first node.
+    const TNodeID literal = assumeVector[boundPtr - boundArray.get()];
+    const State nodeState = literal & 1;
+    nodeID = literal >> 1;
+    if (stateVector[nodeID] == 1 - nodeState) {
+        backtrack_analyzeFinal(nodeID);
+        learnBuffer.push_back(literal);
+        return false;
+    }
+    TNodeID* trueNodeIDPtrEnd = boundPtr->trueNodeIDPtr;
+    TNodeID* falseNodeIDPtrEnd = boundPtr->falseNodeIDPtr;
+    boundPtr->nodeID = nodeID;
+    boundPtr->nodeState = nodeState;
+    boundPtr->state = MAYBE;
+    if (stateVector[nodeID] == MAYBE) {
+        increment(statistics.decisionCount);
+        constrain_updateNode(
+            trueNodeIDPtrEnd, falseNodeIDPtrEnd, 
+            nodeID, nodeState, DECISION);
+        if (!constrain(boundPtr->trueNodeIDPtr, boundPtr->falseNodeIDPtr, trueNodeIDPtrEnd, falseNodeIDPtrEnd)) return false;
+    }
+    *(++boundPtr) = Bound(trueNodeIDPtrEnd, falseNodeIDPtrEnd, TRUE);
+    if constexpr (STATISTICS) raise(statistics.maxBoundDepth, boundPtr - boundArray.get());
+    nodeID = 0;
+    return true;
+}
+
+template<typename TNodeID, typename TLinkID>
+bool BasicEngine<TNodeID,TLinkID>::backtrack_learn(Bound*& boundPtr, TNodeID& nodeID) noexcept
+{
+    // Conflict analysis already ran inside constrain, before its undo; at the
+    // assumptions' levels it left their core instead
+    while (true) {
+        if (level <= assumeVector.size()) {
+            if (level == 0) learnBuffer.clear();
+            return false;
+        }
+        backtrack_jump(boundPtr, nodeID, learnLevel);
+        const TReasonID reasonID = backtrack_store();
+        if (backtrack_assert(boundPtr, nodeID, learnBuffer.front(), reasonID)) return true;
+    }
+}
+
+template<typename TNodeID, typename TLinkID>
+void BasicEngine<TNodeID,TLinkID>::backtrack_jump(Bound*& boundPtr, TNodeID& nodeID, const TNodeID depth) noexcept
+{
+    Bound* jumpPtr = boundArray.get() + depth;
+    undo(
+        jumpPtr->trueNodeIDPtr, boundPtr->trueNodeIDPtr, boundPtr->trueNodeIDPtr,
+        jumpPtr->falseNodeIDPtr, boundPtr->falseNodeIDPtr, boundPtr->falseNodeIDPtr);
+    boundPtr = jumpPtr;
+    nodeID = boundPtr->nodeID;
+    if (heuristic == SLACK) backtrack_unpark(depth + 1);
+}
+
+template<typename TNodeID, typename TLinkID>
+bool BasicEngine<TNodeID,TLinkID>::backtrack_assert(Bound*& boundPtr, const TNodeID nodeID, const TNodeID literal, const TReasonID reasonID) noexcept
+{
+    // Assert the literal at the bound's level, extending its trail segment
+    TNodeID* trueNodeIDPtrStart = boundPtr->trueNodeIDPtr;
+    TNodeID* falseNodeIDPtrStart = boundPtr->falseNodeIDPtr;
+    TNodeID* trueNodeIDPtrEnd = trueNodeIDPtrStart;
+    TNodeID* falseNodeIDPtrEnd = falseNodeIDPtrStart;
+    level = boundPtr - boundArray.get();
+    constrain_updateNode(
+        trueNodeIDPtrEnd, falseNodeIDPtrEnd, 
+        literal >> 1, literal & 1, reasonID);
+    if (!constrain(trueNodeIDPtrStart, falseNodeIDPtrStart, trueNodeIDPtrEnd, falseNodeIDPtrEnd)) return false;
+    *boundPtr = Bound(trueNodeIDPtrEnd, falseNodeIDPtrEnd, TRUE);
+    boundPtr->nodeID = nodeID;
+    return true;
+}
+
+template<typename TNodeID, typename TLinkID>
+void BasicEngine<TNodeID,TLinkID>::backtrack_work(const BasicEngine& root)
+{
+    std::unique_lock<std::mutex> lock(split->mutex);
+    while (true) {
+        split->idleCount++;
+        split->condition.wait(lock, [this] {
+            return split->stop || !split->pathVector.empty() || split->busyCount == 0; });
+        split->idleCount--;
+        if (split->stop || split->pathVector.empty()) {
+            split->exitCount++;
+            split->condition.notify_all();
+            split->exitCondition.notify_one();
+            return;
+        }
+        splitPath = std::move(split->pathVector.back());
+        split->pathVector.pop_back();
+        split->busyCount++;
+        lock.unlock();
+
+        backtrack_restore(root);
+        const bool found = constrain(splitPath) && backtrack();
+
+        lock.lock();
+        split->busyCount--;
+        // Even once stopped by the limits: its subproblem was not left in pathVector
+        if (found && split->solution == nullptr) {
+            split->solution = this;
+            split->stop = true;
+        }
+    }
+}
+
+template<typename TNodeID, typename TLinkID>
+void BasicEngine<TNodeID,TLinkID>::backtrack_restore(const BasicEngine& root)
+{
+    // Back to the root's assignment, dropping links learned under the previous subproblem
+    stateVector = root.stateVector;
+    counterVector = root.counterVector;
+    changeVector = root.changeVector;
+    changeStamp++;
+    phaseVector = root.phaseVector;
+    activityHeap = root.activityHeap;
+    activityIncrement = root.activityIncrement;
+    slackHeap = root.slackHeap;
+    slackParkVector = root.slackParkVector;
+    reasonVector = root.reasonVector;
+    levelVector = root.levelVector;
+    orderVector = root.orderVector;
+    level = root.level;
+    order = root.order;
+    learnLimit = root.learnLimit;
+    learnIncrement = root.learnIncrement;
+    learnVector = root.learnVector;
+    learnNodeVector = root.learnNodeVector;
+    watchVector = root.watchVector;
+    trueNodeIDPtrTop = nodeIDArray.get() + (root.trueNodeIDPtrTop - root.nodeIDArray.get());
+    falseNodeIDPtrTop = nodeIDArray.get() + (root.falseNodeIDPtrTop - root.nodeIDArray.get());
+    splitDepth = 0;
+}
+
+template<typename TNodeID, typename TLinkID>
+bool BasicEngine<TNodeID,TLinkID>::backtrack_split(Bound*& boundPtr, TNodeID& nodeID)
+{
+    // Polled before each decision; false cancels the search
+    if (split->stop.load(std::memory_order_relaxed)) {
+        if (split->limited) {
+            std::lock_guard<std::mutex> lock(split->mutex);
+            backtrack_open(boundPtr, split->pathVector);
+        }
+        return false;
+    }
+    if (split->idleCount.load(std::memory_order_relaxed) == 0) return true;
+    // Learned links let the search return to any decision, so only the first
+    // one can be given away; otherwise take the shallowest unflipped decision
+    Bound* openPtr = nullptr;
+    if (learning) {
+        if (boundPtr > boundArray.get()) openPtr = boundArray.get();
+    } else {
+        splitDepth = std::min<TNodeID>(splitDepth, boundPtr - boundArray.get());
+        for (Bound* ptr = boundArray.get() + splitDepth; ptr < boundPtr; ptr++) {
+            if (ptr->state == FALSE) {
+                openPtr = ptr;
+                break;
+            }
+        }
+        splitDepth = (openPtr != nullptr ? openPtr : boundPtr) - boundArray.get();
+    }
+    if (openPtr == nullptr) return true;
+    {
+        std::lock_guard<std::mutex> lock(split->mutex);
+        if (split->pathVector.size() >= split->idleCount) return true;
+        vector<pair<TNodeID,bool>> path(splitPath);
+        for (const Bound* ptr = boundArray.get(); ptr < openPtr; ptr++)
+            path.push_back({ptr->nodeID, stateVector[ptr->nodeID] == TRUE});
+        path.push_back({openPtr->nodeID, openPtr->nodeState != TRUE});
+        split->pathVector.push_back(std::move(path));
+    }
+    split->condition.notify_one();
+    if (!learning) {
+        openPtr->state = MAYBE;
+        return true;
+    }
+    // Keep the first decision as a fact of this worker's subproblem
+    const TNodeID literal = 2 * openPtr->nodeID + openPtr->nodeState;
+    splitPath.push_back({openPtr->nodeID, openPtr->nodeState == TRUE});
+    backtrack_jump(boundPtr, nodeID, 0);
+    return backtrack_assert(boundPtr, nodeID, literal, DECISION);
+}
+
+template<typename TNodeID, typename TLinkID>
+void BasicEngine<TNodeID,TLinkID>::backtrack_analyze() noexcept
+{
+    // Resolve the conflict back through reasons until a single node of the
+    // conflict level remains (first unique implication point)
+    learnBuffer.assign(1, 0);
+    analyzeHeap.clear();
+    backtrack_analyzeReason(conflictLinkID, ~TOrder(0), NONE);
+    TNodeID nodeID;
+    while (true) {
+        std::pop_heap(analyzeHeap.begin(), analyzeHeap.end());
+        nodeID = analyzeHeap.back().second;
+        analyzeHeap.pop_back();
+        if (analyzeHeap.empty()) break;
+        backtrack_analyzeReason(reasonVector[nodeID], orderVector[nodeID], nodeID);
+    }
+    learnBuffer.front() = 2 * nodeID + (1 - stateVector[nodeID]);
+    // Jump to the deepest remaining level; its literal becomes the second watch
+    learnLevel = 0;
+    for (TNodeID i = 1; i < learnBuffer.size(); i++) {
+        TNodeID literalLevel = levelVector[learnBuffer[i] >> 1];
+        if (literalLevel > learnLevel) {
+            learnLevel = literalLevel;
+            std::swap(learnBuffer[1], learnBuffer[i]);
+        }
+    }
+    for (TNodeID seenNodeID : seenNodeVector)
+        seenVector[seenNodeID] = false;
+    seenNodeVector.clear();
+    if (heuristic == ACTIVITY) activityIncrement /= 0.95;
+    learnIncrement /= 0.999;
+}
+
+template<typename TNodeID, typename TLinkID>
+inline void BasicEngine<TNodeID,TLinkID>::backtrack_analyzeConflict() noexcept
+{
+    // Up to the last assumption's level every decision is an assumption
+    if (level <= assumeVector.size()) backtrack_analyzeFinal(NONE);
+    else if (learning) backtrack_analyze();
+}
+
+template<typename TNodeID, typename TLinkID>
+void BasicEngine<TNodeID,TLinkID>::backtrack_analyzeFinal(const TNodeID nodeID) noexcept
+{
+    // Resolve the conflict link, or what ruled out nodeID, back through every
+    // level above 0; the decisions reached are the assumptions responsible
+    learnBuffer.clear();
+    analyzeHeap.clear();
+    const TNodeID conflictLevel = level;
+    level = 1;
+    if (nodeID == NONE) backtrack_analyzeReason(conflictLinkID, ~TOrder(0), NONE);
+    else backtrack_analyzeNode(nodeID);
+    while (!analyzeHeap.empty()) {
+        std::pop_heap(analyzeHeap.begin(), analyzeHeap.end());
+        const TNodeID reasonNodeID = analyzeHeap.back().second;
+        analyzeHeap.pop_back();
+        if (reasonVector[reasonNodeID] == DECISION)
+            learnBuffer.push_back(2 * reasonNodeID + stateVector[reasonNodeID]);
+        else
+            backtrack_analyzeReason(reasonVector[reasonNodeID], orderVector[reasonNodeID], reasonNodeID);
+    }
+    level = conflictLevel;
+    for (TNodeID seenNodeID : seenNodeVector)
+        seenVector[seenNodeID] = false;
+    seenNodeVector.clear();
+}
+
+template<typename TNodeID, typename TLinkID>
+void BasicEngine<TNodeID,TLinkID>::backtrack_analyzeReason(const TReasonID reasonID, const TOrder orderLimit, const TNodeID nodeID) noexcept
+{
+    const Kind kind = reasonID < counterVector.size() ? getLinkKind(reasonID) : GENERIC;
+    if (kind == AT_MOST_ONE || kind == EXACTLY_ONE) {
+        // A FALSE node was ruled out by TRUE nodes and a TRUE node forced by FALSE nodes;
+        // a conflict has two TRUE nodes or no node left
+        const TOffset* offsetPtr = getLinkOffsets(reasonID);
+        const TNodeID* linkNodeArray = getLinkNodes(reasonID);
+        State countState;
+        if (nodeID != NONE) {
+            countState = 1 - stateVector[nodeID];
+        } else {
+            TNodeID trueCount = 0;
+            for (TOffset i = offsetPtr[2]; i < offsetPtr[3]; i++)
+                trueCount += stateVector[linkNodeArray[i]] == TRUE;
+            countState = trueCount >= 2 ? TRUE : FALSE;
+        }
+        for (TOffset i = offsetPtr[2]; i < offsetPtr[3]; i++) {
+            const TNodeID reasonNodeID = linkNodeArray[i];
+            if (reasonNodeID != nodeID && 
+                stateVector[reasonNodeID] == countState && 
+                orderVector[reasonNodeID] < orderLimit)
+                backtrack_analyzeNode(reasonNodeID);
+        }
+    } else if (reasonID < counterVector.size()) {
+        // Nodes of the link already counted when nodeID was assigned
+        const TOffset* offsetPtr = getLinkOffsets(reasonID);
+        const TNodeID* linkNodeArray = getLinkNodes(reasonID);
+        for (TOffset k = 0; k < 4; k++) {
+            const State countState = k % 2 == 0 ? TRUE : FALSE;
+            for (TOffset i = offsetPtr[k]; i < offsetPtr[k + 1]; i++) {
+                const TNodeID reasonNodeID = linkNodeArray[i];
+                if (reasonNodeID != nodeID && 
+                    stateVector[reasonNodeID] == countState && 
+                    orderVector[reasonNodeID] < orderLimit)
+                    backtrack_analyzeNode(reasonNodeID);
+            }
+        }
+    } else {
+        Learn& learn = learnVector[reasonID - counterVector.size()];
+        learn.activity += learnIncrement;
+        if (learn.activity > 1e20) {
+            for (Learn& other : learnVector) other.activity *= 1e-20;
+            learnIncrement *= 1e-20;
+        }
+        const TNodeID* ptr = learnNodeVector.data() + learn.offset;
+        const TNodeID* endPtr = ptr + learn.size;
+        for ( ; ptr < endPtr; ptr++)
+            if ((*ptr >> 1) != nodeID) backtrack_analyzeNode(*ptr >> 1);
+    }
+}
+
+template<typename TNodeID, typename TLinkID>
+void BasicEngine<TNodeID,TLinkID>::backtrack_analyzeNode(const TNodeID nodeID) noexcept
+{
+    if (seenVector[nodeID] || levelVector[nodeID] == 0) return;
+    seenVector[nodeID] = true;
+    seenNodeVector.push_back(nodeID);
+    if (heuristic == ACTIVITY) backtrack_bumpNode(nodeID);
+    if (levelVector[nodeID] >= level) {
+        analyzeHeap.push_back({orderVector[nodeID], nodeID});
+        std::push_heap(analyzeHeap.begin(), analyzeHeap.end());
+    } else {
+        learnBuffer.push_back(2 * nodeID + (1 - stateVector[nodeID]));
+    }
+}
+
+template<typename TNodeID, typename TLinkID>
+TReasonID BasicEngine<TNodeID,TLinkID>::backtrack_store() noexcept
+{
+    // Units hold at level 0 and need no link
+    if (learnBuffer.size() == 1) return DECISION;
+    if (learnVector.size() >= learnLimit) backtrack_reduce();
+    // Glue: distinct decision levels in the learned link
+    vector<TNodeID> levels;
+    levels.reserve(learnBuffer.size());
+    for (TNodeID literal : learnBuffer) levels.push_back(levelVector[literal >> 1]);
+    std::sort(levels.begin(), levels.end());
+    TNodeID glue = std::unique(levels.begin(), levels.end()) - levels.begin();
+
+    TReasonID learnID = learnVector.size();
+    learnVector.push_back({(TOffset) learnNodeVector.size(), (TNodeID) learnBuffer.size(), glue, learnIncrement, order});
+    learnNodeVector.insert(learnNodeVector.end(), learnBuffer.cbegin(), learnBuffer.cend());
+    watchVector[learnBuffer[0]].push_back(learnID);
+    watchVector[learnBuffer[1]].push_back(learnID);
+    return counterVector.size() + learnID;
+}
+
+template<typename TNodeID, typename TLinkID>
+bool BasicEngine<TNodeID,TLinkID>::backtrack_isLocked(const TReasonID learnID) const noexcept
+{
+    // The first literal of a learned link is the one it last implied
+    const TNodeID nodeID = learnNodeVector[learnVector[learnID].offset] >> 1;
+    return stateVector[nodeID] != MAYBE && reasonVector[nodeID] == counterVector.size() + learnID;
+}
+
+template<typename TNodeID, typename TLinkID>
+void BasicEngine<TNodeID,TLinkID>::backtrack_reduce() noexcept
+{
+    // Drop the less active half of the learned links, keeping low glue
+    // and locked ones, then compact and rebuild the watches
+    vector<TReasonID> candidates;
+    for (TReasonID learnID = 0; learnID < learnVector.size(); learnID++)
+        if (learnVector[learnID].glue > 2 && !backtrack_isLocked(learnID))
+            candidates.push_back(learnID);
+    std::sort(candidates.begin(), candidates.end(), [this](TReasonID a, TReasonID b) {
+        return learnVector[a].activity < learnVector[b].activity;
+    });
+    vector<bool> removeVector(learnVector.size(), false);
+    for (TReasonID i = 0; i < candidates.size() / 2; i++)
+        removeVector[candidates[i]] = true;
+
+    const TReasonID linkSize = counterVector.size();
+    vector<TReasonID> idVector(learnVector.size(), DECISION);
+    vector<Learn> newLearnVector;
+    vector<TNodeID> newLearnNodeVector;
+    newLearnNodeVector.reserve(learnNodeVector.size());
+    for (TReasonID learnID = 0; learnID < learnVector.size(); learnID++) {
+        if (removeVector[learnID]) continue;
+        Learn learn = learnVector[learnID];
+        const TNodeID* ptr = learnNodeVector.data() + learn.offset;
+        learn.offset = newLearnNodeVector.size();
+        newLearnNodeVector.insert(newLearnNodeVector.end(), ptr, ptr + learn.size);
+        idVector[learnID] = newLearnVector.size();
+        newLearnVector.push_back(learn);
+    }
+    learnVector = std::move(newLearnVector);
+    learnNodeVector = std::move(newLearnNodeVector);
+    for (TNodeID nodeID = 0; nodeID < stateVector.size(); nodeID++) {
+        TReasonID& reasonID = reasonVector[nodeID];
+        if (reasonID != DECISION && reasonID >= linkSize)
+            reasonID = stateVector[nodeID] == MAYBE || idVector[reasonID - linkSize] == DECISION ? 
+                DECISION : linkSize + idVector[reasonID - linkSize];
+    }
+    backtrack_watch();
+    learnLimit += learnLimit / 10 + 1;
+}
+
+template<typename TNodeID, typename TLinkID>
+void BasicEngine<TNodeID,TLinkID>::backtrack_watch() noexcept
+{
+    for (vector<TReasonID>& watches : watchVector) watches.clear();
+    for (TReasonID learnID = 0; learnID < learnVector.size(); learnID++) {
+        const TNodeID* ptr = learnNodeVector.data() + learnVector[learnID].offset;
+        watchVector[ptr[0]].push_back(learnID);
+        watchVector[ptr[1]].push_back(learnID);
+    }
+}
+
+template<typename TNodeID, typename TLinkID>
+void BasicEngine<TNodeID,TLinkID>::backtrack_forget(const TOrder order) noexcept
+{
+    // Reductions keep learned links in creation order, so the ones learned
+    // since order are a suffix
+    TReasonID learnSize = learnVector.size();
+    while (learnSize > 0 && learnVector[learnSize - 1].order >= order) learnSize--;
+    if (learnSize == learnVector.size()) return;
+    for (TReasonID learnID = learnSize; learnID < learnVector.size(); learnID++) {
+        const TNodeID* ptr = learnNodeVector.data() + learnVector[learnID].offset;
+        for (TNodeID k = 0; k < 2; k++) {
+            vector<TReasonID>& watches = watchVector[ptr[k]];
+            watches.erase(std::remove_if(watches.begin(), watches.end(), 
+                [learnSize](TReasonID watchID) { return watchID >= learnSize; }), watches.end());
+        }
+    }
+    learnNodeVector.resize(learnVector[learnSize].offset);
+    learnVector.resize(learnSize);
+}
+
+template<typename TNodeID, typename TLinkID>
+bool BasicEngine<TNodeID,TLinkID>::constrain(
+    TNodeID* trueNodeIDPtrStart, TNodeID* falseNodeIDPtrStart, 
+    TNodeID*& trueNodeIDPtrEnd, TNodeID*& falseNodeIDPtrEnd) noexcept
+{
+    TNodeID* trueNodeIDPtr = trueNodeIDPtrStart;
+    TNodeID* falseNodeIDPtr = falseNodeIDPtrStart;
+    changeStamp++;
+
+    while (true) {
+        for ( ; trueNodeIDPtr < trueNodeIDPtrEnd; trueNodeIDPtr++) {
+            if (!constrain_updateLinkArray(
+                    trueNodeIDPtrEnd, falseNodeIDPtrEnd, 
+                    *trueNodeIDPtr, TRUE)) {
+                if (level > 0) backtrack_analyzeConflict();
+                undo(
+                    trueNodeIDPtrStart, trueNodeIDPtr, trueNodeIDPtrEnd, 
+                    falseNodeIDPtrStart, falseNodeIDPtr, falseNodeIDPtrEnd);
+                return false;
+            }
+            if (!lazyWatchVector.empty() && !constrain_updateLazyArray(
+                    trueNodeIDPtrEnd, falseNodeIDPtrEnd, 
+                    *trueNodeIDPtr, TRUE)) {
+                if (level > 0) backtrack_analyzeConflict();
+                undo(
+                    trueNodeIDPtrStart, trueNodeIDPtr + 1, trueNodeIDPtrEnd, 
+                    falseNodeIDPtrStart, falseNodeIDPtr, falseNodeIDPtrEnd);
+                return false;
+            }
+            if (learning && !constrain_updateLearnArray(
+                    trueNodeIDPtrEnd, falseNodeIDPtrEnd, 
+                    *trueNodeIDPtr, TRUE)) {
+                if (level > 0) backtrack_analyzeConflict();
+                undo(
+                    trueNodeIDPtrStart, trueNodeIDPtr + 1, trueNodeIDPtrEnd, 
+                    falseNodeIDPtrStart, falseNodeIDPtr, falseNodeIDPtrEnd);
+                return false;
+            }
+        }
+        if (!(falseNodeIDPtr > falseNodeIDPtrEnd)) break;
+
+        for ( ; falseNodeIDPtr > falseNodeIDPtrEnd; falseNodeIDPtr--) {
+            if (!constrain_updateLinkArray(
+                    trueNodeIDPtrEnd, falseNodeIDPtrEnd, 
+                    *falseNodeIDPtr, FALSE)) {
+                if (level > 0) backtrack_analyzeConflict();
+                undo(
+                    trueNodeIDPtrStart, trueNodeIDPtr, trueNodeIDPtrEnd, 
+                    falseNodeIDPtrStart, falseNodeIDPtr, falseNodeIDPtrEnd);
+                return false;
+            }
+            if (!lazyWatchVector.empty() && !constrain_updateLazyArray(
+                    trueNodeIDPtrEnd, falseNodeIDPtrEnd, 
+                    *falseNodeIDPtr, FALSE)) {
+                if (level > 0) backtrack_analyzeConflict();
+                undo(
+                    trueNodeIDPtrStart, trueNodeIDPtr, trueNodeIDPtrEnd, 
+                    falseNodeIDPtrStart, falseNodeIDPtr - 1, falseNodeIDPtrEnd);
+                return false;
+            }
+            if (learning && !constrain_updateLearnArray(
+                    trueNodeIDPtrEnd, falseNodeIDPtrEnd, 
+                    *falseNodeIDPtr, FALSE)) {
+                if (level > 0) backtrack_analyzeConflict();
+                undo(
+                    trueNodeIDPtrStart, trueNodeIDPtr, trueNodeIDPtrEnd, 
+                    falseNodeIDPtrStart, falseNodeIDPtr - 1, falseNodeIDPtrEnd);
+                return false;
+            }
+        }
+        if (!(trueNodeIDPtr < trueNodeIDPtrEnd)) break;
+    }
+    if constexpr (STATISTICS) raise(statistics.maxTrailDepth, 
+        (trueNodeIDPtrEnd - nodeIDArray.get()) + (nodeIDArray.get() + stateVector.size() - 1 - falseNodeIDPtrEnd));
+    return true;
+}
+
+template<typename TNodeID, typename TLinkID>
+void BasicEngine<TNodeID,TLinkID>::constrain_watch() noexcept
+{
+    // Watch the out nodes of each lazy link not counted by the states first; a link
+    // with fewer of them than it watches has fired already
+    lazyVector.clear();
+    lazyNodeVector.clear();
+    lazyWatchVector.clear();
+    for (TLinkID linkID = 0; linkID < problem->linkSize; linkID++) {
+        if (problem->kindArray[linkID] != LAZY) continue;
+        const TOffset* offsetPtr = problem->linkOffsetArray + 4 * linkID;
+        const TNodeID size = offsetPtr[4] - offsetPtr[2];
+        const TNodeID watchSize = size - problem->limitArray[linkID].second + 1;
+        const TOffset offset = lazyNodeVector.size();
+        for (TOffset i = offsetPtr[2]; i < offsetPtr[4]; i++)
+            lazyNodeVector.push_back(2 * problem->linkNodeArray[i] + (i < offsetPtr[3] ? TRUE : FALSE));
+        std::partition(lazyNodeVector.begin() + offset, lazyNodeVector.end(), 
+            [this](TNodeID literal) { return stateVector[literal >> 1] != (literal & 1); });
+        lazyVector.push_back({linkID, offset, size, watchSize, watchSize});
+    }
+    if (lazyVector.empty()) return;
+    lazyWatchVector.resize(2 * stateVector.size());
+    for (TLinkID lazyID = 0; lazyID < lazyVector.size(); lazyID++) {
+        const TNodeID* literals = lazyNodeVector.data() + lazyVector[lazyID].offset;
+        for (TNodeID i = 0; i < lazyVector[lazyID].watchSize; i++)
+            lazyWatchVector[literals[i]].push_back({lazyID, i});
+    }
+}
+
+template<typename TNodeID, typename TLinkID>
+void BasicEngine<TNodeID,TLinkID>::undo(
+    TNodeID* trueNodeIDPtrStart, TNodeID* trueNodeIDPtrMid, TNodeID* trueNodeIDPtrEnd,
+    TNodeID* falseNodeIDPtrStart, TNodeID* falseNodeIDPtrMid, TNodeID* falseNodeIDPtrEnd) noexcept
+{
+    // Nodes are assigned in trail order and each range starts where a constrain
+    // did, so the first node of either stack marks every change made since
+    TOffset mark = changeVector.size();
+    if (trueNodeIDPtrStart < trueNodeIDPtrEnd) mark = std::min(mark, changeMarkVector[*trueNodeIDPtrStart]);
+    if (falseNodeIDPtrStart > falseNodeIDPtrEnd) mark = std::min(mark, changeMarkVector[*falseNodeIDPtrStart]);
+    undo_restore(mark);
+
+    for ( ; trueNodeIDPtrStart < trueNodeIDPtrMid; trueNodeIDPtrStart++) {
+        undo_updateNode(*trueNodeIDPtrStart);
+        undo_updateLinkArray(*trueNodeIDPtrStart, TRUE);
+    }
+    for ( ; trueNodeIDPtrStart < trueNodeIDPtrEnd; trueNodeIDPtrStart++)
+        undo_updateNode(*trueNodeIDPtrStart);
+
+    for ( ; falseNodeIDPtrStart > falseNodeIDPtrMid; falseNodeIDPtrStart--) {
+        undo_updateNode(*falseNodeIDPtrStart);
+        undo_updateLinkArray(*falseNodeIDPtrStart, FALSE);
+    }
+    for ( ; falseNodeIDPtrStart > falseNodeIDPtrEnd; falseNodeIDPtrStart--)
+        undo_updateNode(*falseNodeIDPtrStart);
+}
+
+template<typename TNodeID, typename TLinkID>
+void BasicEngine<TNodeID,TLinkID>::undo_restore(const TOffset mark) noexcept
+{
+    if constexpr (STATISTICS) increment(statistics.undoLinkCount, changeVector.size() - mark);
+    while (changeVector.size() > mark) {
+        const Change& change = changeVector.back();
+        Counter& counter = counterVector[change.linkID];
+        counter.inCount = change.inCount;
+        counter.outCount = change.outCount;
+        if (heuristic == SLACK) backtrack_updateSlack(change.linkID);
+        changeVector.pop_back();
+    }
+    changeStamp++;
+}
+
+template<typename TNodeID, typename TLinkID>
+void BasicEngine<TNodeID,TLinkID>::undo_updateNode(const TNodeID nodeID) noexcept
+{
+    State& nodeState = stateVector[nodeID];
+    if (phaseSaving) phaseVector[nodeID] = nodeState;
+    nodeState = MAYBE;
+    if (heuristic == ACTIVITY) activityHeap.push(nodeID);
+}
+
+template<typename TNodeID, typename TLinkID>
+void BasicEngine<TNodeID,TLinkID>::undo_updateLinkArray(const TNodeID nodeID, const State state) noexcept
+{
+    // Only added links are counted down per node; the problem's come back from the counter trail
+    assert(state == TRUE || state == FALSE);
+    if (addNodeLinkVector.empty()) return;
+    const vector<pair<TLinkID,Side>>& adds = addNodeLinkVector[2 * nodeID + state];
+    undo_updateAddArray(adds.data(), adds.data() + adds.size(), state);
+}
+
+template<typename TNodeID, typename TLinkID>
+void BasicEngine<TNodeID,TLinkID>::undo_updateAddArray(
+    const pair<TLinkID,Side>* ptr, const pair<TLinkID,Side>* endPtr, const State state) noexcept
+{
+    if constexpr (STATISTICS) increment(statistics.undoLinkCount, endPtr - ptr);
+    for ( ; ptr < endPtr; ptr++) {
+        Counter& counter = counterVector[ptr->first];
+        if (ptr->second == IN || (ptr->second == GROUP && state == FALSE)) counter.inCount--;
+        else                                                               counter.outCount--;
+        if (heuristic == SLACK) backtrack_updateSlack(ptr->first);
+    }
+}
+
+template<typename TNodeID, typename TLinkID>
+bool BasicEngine<TNodeID,TLinkID>::constrain_updateLinkArray(
+    TNodeID*& trueNodeIDPtrEnd, TNodeID*& falseNodeIDPtrEnd, 
+    const TNodeID nodeID, const State state) noexcept
+{
+    assert(state == TRUE || state == FALSE);
+    if constexpr (STATISTICS) increment(statistics.propagationCount);
+    const TOffset* offsetPtr = problem->nodeOffsetArray + 6 * nodeID + (state == TRUE ? 0 : 3);
+    const TLinkID* linkIDArray = problem->nodeLinkArray;
+    const TLinkID* startPtr = linkIDArray + offsetPtr[0];
+    const TLinkID* inPtr = linkIDArray + offsetPtr[1];
+    const TLinkID* outPtr = linkIDArray + offsetPtr[2];
+    const TLinkID* groupPtr = linkIDArray + offsetPtr[3];
+    const TLinkID* ptr = startPtr;
+    // On a conflict undo restores the problem's links, this node's included
+    for ( ; ptr < inPtr; ptr++)
+        if (!constrain_updateLink(
             trueNodeIDPtrEnd, falseNodeIDPtrEnd, 
-            *ptr, IN, reset, propagate)) return false;
-    for (TLinkID* outPtr = ptr + outLen; ptr < outPtr; ptr++)
+            *ptr, IN)) return false;
+    for ( ; ptr < outPtr; ptr++)
         if (!constrain_updateLink(
             trueNodeIDPtrEnd, falseNodeIDPtrEnd, 
-            *ptr, OUT, reset, propagate)) return false;
+            *ptr, OUT)) return false;
+    for ( ; ptr < groupPtr; ptr++)
+        if (!constrain_updateGroup(
+            trueNodeIDPtrEnd, falseNodeIDPtrEnd, 
+            *ptr, state)) return false;
+    if (addNodeLinkVector.empty()) return true;
+    const vector<pair<TLinkID,Side>>& adds = addNodeLinkVector[2 * nodeID + state];
+    for (const pair<TLinkID,Side>* addPtr = adds.data(); addPtr < adds.data() + adds.size(); addPtr++) {
+        const bool consistent = addPtr->second == GROUP ?
+            constrain_updateGroup(trueNodeIDPtrEnd, falseNodeIDPtrEnd, addPtr->first, state) :
+            constrain_updateLink(trueNodeIDPtrEnd, falseNodeIDPtrEnd, addPtr->first, addPtr->second);
+        if (!consistent) {
+            // Revert this node's added links so undo can treat it as unvisited
+            undo_updateAddArray(adds.data(), addPtr + 1, state);
+            return false;
+        }
+    }
     return true;
 }
 
-bool Engine::constrain_updateLink(
+template<typename TNodeID, typename TLinkID>
+bool BasicEngine<TNodeID,TLinkID>::constrain_updateLink(
     TNodeID*& trueNodeIDPtrEnd, TNodeID*& falseNodeIDPtrEnd, 
-    const TLinkID linkID, const Side side, const bool reset, const bool propagate) noexcept
+    const TLinkID linkID, const Side side) noexcept
 {
     assert(side == IN || side == OUT);
-    Link& link = linkVector[linkID];
-    if (side == IN) {
-        if (reset) link.inCount--;
-        else       link.inCount++;
-    } else {
-        if (reset) link.outCount--;
-        else       link.outCount++;
+    constrain_change(linkID);
+    Counter& counter = counterVector[linkID];
+    if (side == IN) counter.inCount++;
+    else            counter.outCount++;
+    if constexpr (STATISTICS) if (linkID < statistics.linkCountVector.size()) increment(statistics.linkCountVector[linkID]);
+    if (heuristic == SLACK) backtrack_updateSlack(linkID);
+    const TNodeID* linkNodeArray = getLinkNodes(linkID);
+    const TOffset* offsetPtr = getLinkOffsets(linkID);
+    bool consistent = true;
+    if (counter.isJustConditional())
+        consistent = constrain_updateNodeArray(
+            trueNodeIDPtrEnd, falseNodeIDPtrEnd, 
+            linkNodeArray + offsetPtr[2], linkNodeArray + offsetPtr[3], linkNodeArray + offsetPtr[4], 
+            counter.outLimit, getLinkRanges(linkID) >> 2, linkID);
+    else if (counter.isJustContrapositive())
+        consistent = constrain_updateNodeArray(
+            trueNodeIDPtrEnd, falseNodeIDPtrEnd, 
+            linkNodeArray + offsetPtr[0], linkNodeArray + offsetPtr[1], linkNodeArray + offsetPtr[2], 
+            counter.inLimit, getLinkRanges(linkID) & 0b11, linkID);
+    if (!consistent) {
+        conflictLinkID = linkID;
+        increment(statistics.conflictCount);
     }
-    return propagate ? constrain_updateNodeArray(trueNodeIDPtrEnd, falseNodeIDPtrEnd, link, reset) : true;
+    return consistent;
+}
+
+template<typename TNodeID, typename TLinkID>
+void BasicEngine<TNodeID,TLinkID>::constrain_change(const TLinkID linkID) noexcept
+{
+    // Keep a problem link's counts from before its first change in this stamp
+    if (linkID >= changeStampVector.size() || changeStampVector[linkID] == changeStamp) return;
+    changeStampVector[linkID] = changeStamp;
+    const Counter& counter = counterVector[linkID];
+    changeVector.push_back({linkID, counter.inCount, counter.outCount});
 }
 
-bool Engine::constrain_updateNodeArray(
+template<typename TNodeID, typename TLinkID>
+bool BasicEngine<TNodeID,TLinkID>::constrain_updateGroup(
     TNodeID*& trueNodeIDPtrEnd, TNodeID*& falseNodeIDPtrEnd, 
-    const Link& link, const bool reset) noexcept
+    const TLinkID linkID, const State state) noexcept
 {
-    if (reset) {
-        if (link.isJustNotConditional())
-            return constrain_updateNodeArray(
-                trueNodeIDPtrEnd, falseNodeIDPtrEnd, 
-                link.outArray, link.trueOutLen, link.falseOutLen, link.outLimit, reset);
-        else if (link.isJustNotContrapositive())
-            return constrain_updateNodeArray(
-                trueNodeIDPtrEnd, falseNodeIDPtrEnd, 
-                link.inArray, link.trueInLen, link.falseInLen, link.inLimit, reset);
-    } else {
-        if (link.isJustConditional())
-            return constrain_updateNodeArray(
-                trueNodeIDPtrEnd, falseNodeIDPtrEnd, 
-                link.outArray, link.trueOutLen, link.falseOutLen, link.outLimit, reset);
-        else if (link.isJustContrapositive())
-            return constrain_updateNodeArray(
-                trueNodeIDPtrEnd, falseNodeIDPtrEnd, 
-                link.inArray, link.trueInLen, link.falseInLen, link.inLimit, reset);
+    assert(state == TRUE || state == FALSE);
+    constrain_change(linkID);
+    Counter& counter = counterVector[linkID];
+    if (state == TRUE) counter.outCount++;
+    else               counter.inCount++;
+    if constexpr (STATISTICS) if (linkID < statistics.linkCountVector.size()) increment(statistics.linkCountVector[linkID]);
+    if (heuristic == SLACK) backtrack_updateSlack(linkID);
+    const TNodeID* linkNodeArray = getLinkNodes(linkID);
+    const TOffset* offsetPtr = getLinkOffsets(linkID);
+    const TNodeID* ptr = linkNodeArray + offsetPtr[2];
+    const TNodeID* endPtr = linkNodeArray + offsetPtr[3];
+    const bool isRange = getLinkRanges(linkID) & 0b100;
+    bool consistent = true;
+    // The first TRUE node rules out the rest; with exactly one,
+    // the last node not FALSE must be TRUE
+    if (state == TRUE && counter.outCount == counter.outLimit)
+        consistent = constrain_updateNodeArray(
+            trueNodeIDPtrEnd, falseNodeIDPtrEnd, 
+            ptr, endPtr, endPtr, counter.outLimit, isRange ? 0b01 : 0, linkID);
+    else if (state == FALSE && counter.inCount >= counter.inLimit)
+        consistent = constrain_updateNodeArray(
+            trueNodeIDPtrEnd, falseNodeIDPtrEnd, 
+            ptr, ptr, endPtr, counter.inLimit, isRange ? 0b10 : 0, linkID);
+    if (!consistent) {
+        conflictLinkID = linkID;
+        increment(statistics.conflictCount);
     }
-    return true;
+    return consistent;
 }
 
-bool Engine::constrain_updateNodeArray(
+template<typename TNodeID, typename TLinkID>
+bool BasicEngine<TNodeID,TLinkID>::constrain_updateNodeArray(
     TNodeID*& trueNodeIDPtrEnd, TNodeID*& falseNodeIDPtrEnd, 
-    const unique_ptr<TNodeID[]>& linkArray, const TNodeID trueLen, const TNodeID falseLen, const TNodeID exLimit, const bool reset) noexcept
+    const TNodeID* ptr, const TNodeID* truePtr, const TNodeID* falsePtr, const TNodeID exLimit,
+    const unsigned char ranges, const TReasonID reasonID) noexcept
 {
+    // Bit 0 of ranges: [ptr, truePtr) is a run, bit 1: [truePtr, falsePtr) is a run
     TNodeID count = 0;
-    const TNodeID* ptr = linkArray.get();
-    for (const TNodeID* truePtr = ptr + trueLen; ptr < truePtr; ptr++)
+    if (ranges & 0b01) {
+        if (!constrain_updateNodeRange(
+            trueNodeIDPtrEnd, falseNodeIDPtrEnd, 
+            *ptr, truePtr - ptr, FALSE, count, exLimit, reasonID)) return false;
+        ptr = truePtr;
+    }
+    for ( ; ptr < truePtr; ptr++)
         if (!constrain_updateNode(
             trueNodeIDPtrEnd, falseNodeIDPtrEnd, 
-            *ptr, FALSE, reset) && ++count > exLimit) return false;
-    for (const TNodeID* falsePtr = ptr + falseLen; ptr < falsePtr; ptr++)
+            *ptr, FALSE, reasonID) && ++count > exLimit) return false;
+    if (ranges & 0b10) {
+        if (!constrain_updateNodeRange(
+            trueNodeIDPtrEnd, falseNodeIDPtrEnd, 
+            *ptr, falsePtr - ptr, TRUE, count, exLimit, reasonID)) return false;
+        ptr = falsePtr;
+    }
+    for ( ; ptr < falsePtr; ptr++)
         if (!constrain_updateNode(
             trueNodeIDPtrEnd, falseNodeIDPtrEnd, 
-            *ptr, TRUE, reset) && ++count > exLimit) return false;
+            *ptr, TRUE, reasonID) && ++count > exLimit) return false;
     assert(count == exLimit);
     return true;
 }
 
-bool Engine::constrain_updateNode(
+template<typename TNodeID, typename TLinkID>
+bool BasicEngine<TNodeID,TLinkID>::constrain_updateNodeRange(
     TNodeID*& trueNodeIDPtrEnd, TNodeID*& falseNodeIDPtrEnd, 
-    const TNodeID nodeID, const State state, const bool reset) noexcept
+    const TNodeID nodeID, const TNodeID size, const State state, TNodeID& count, const TNodeID exLimit,
+    const TReasonID reasonID) noexcept
 {
-    assert(state == TRUE || state == FALSE);
-    Node& node = nodeVector[nodeID];
-    if (node.state == (1 - state)) return false;
-    State checkState, newState;
-    if (reset) {
-        checkState = state;
-        newState = MAYBE;
-    } else {
-        checkState = MAYBE;
-        newState = state;
+    // 64 nodes at a time: count those already opposite from masks, then visit only the MAYBE ones
+    for (TNodeID offset = 0; offset < size; offset += 64) {
+        const TNodeID runSize = std::min<TNodeID>(size - offset, 64);
+        const TMask runMask = runSize == 64 ? ~TMask(0) : (TMask(1) << runSize) - 1;
+        TMask trueMask, maybeMask;
+        maskStates(stateVector.data() + nodeID + offset, runSize, trueMask, maybeMask);
+        const TMask oppositeMask = state == TRUE ? runMask & ~(trueMask | maybeMask) : trueMask;
+        count += __builtin_popcountll(oppositeMask);
+        if (count > exLimit) return false;
+        for ( ; maybeMask; maybeMask &= maybeMask - 1)
+            constrain_updateNode(
+                trueNodeIDPtrEnd, falseNodeIDPtrEnd, 
+                nodeID + offset + __builtin_ctzll(maybeMask), state, reasonID);
+    }
+    return true;
+}
+
+template<typename TNodeID, typename TLinkID>
+bool BasicEngine<TNodeID,TLinkID>::constrain_updateLearnArray(
+    TNodeID*& trueNodeIDPtrEnd, TNodeID*& falseNodeIDPtrEnd, 
+    const TNodeID nodeID, const State state) noexcept
+{
+    // Visit the learned links watching the literal this assignment falsified
+    const TNodeID falseLiteral = 2 * nodeID + (1 - state);
+    vector<TReasonID>& watches = watchVector[falseLiteral];
+    TReasonID* ptr = watches.data();
+    TReasonID* keepPtr = ptr;
+    TReasonID* endPtr = ptr + watches.size();
+    bool consistent = true;
+    for ( ; ptr < endPtr; ptr++) {
+        const TReasonID learnID = *ptr;
+        const Learn& learn = learnVector[learnID];
+        TNodeID* literals = learnNodeVector.data() + learn.offset;
+        if (literals[0] == falseLiteral) std::swap(literals[0], literals[1]);
+        // Satisfied
+        if (stateVector[literals[0] >> 1] == (literals[0] & 1)) {
+            *(keepPtr++) = learnID;
+            continue;
+        }
+        // Move the watch to another literal that is not false
+        TNodeID i = 2;
+        for ( ; i < learn.size; i++)
+            if (stateVector[literals[i] >> 1] != 1 - (literals[i] & 1)) break;
+        if (i < learn.size) {
+            std::swap(literals[1], literals[i]);
+            watchVector[literals[1]].push_back(learnID);
+            continue;
+        }
+        // Unit or conflicting
+        *(keepPtr++) = learnID;
+        if (!constrain_updateNode(
+                trueNodeIDPtrEnd, falseNodeIDPtrEnd, 
+                literals[0] >> 1, literals[0] & 1, counterVector.size() + learnID)) {
+            conflictLinkID = counterVector.size() + learnID;
+            increment(statistics.conflictCount);
+            consistent = false;
+            for (ptr++; ptr < endPtr; ptr++) *(keepPtr++) = *ptr;
+            break;
+        }
     }
-    if (node.state == checkState) {
-        node.state = newState;
+    watches.resize(keepPtr - watches.data());
+    return consistent;
+}
+
+template<typename TNodeID, typename TLinkID>
+bool BasicEngine<TNodeID,TLinkID>::constrain_updateLazyArray(
+    TNodeID*& trueNodeIDPtrEnd, TNodeID*& falseNodeIDPtrEnd, 
+    const TNodeID nodeID, const State state) noexcept
+{
+    // Visit the lazy links watching the literal this assignment counted; watches
+    // need no undo, as unassigning nodes never counts one
+    const TNodeID countLiteral = 2 * nodeID + state;
+    vector<pair<TLinkID,TNodeID>>& watches = lazyWatchVector[countLiteral];
+    pair<TLinkID,TNodeID>* ptr = watches.data();
+    pair<TLinkID,TNodeID>* keepPtr = ptr;
+    pair<TLinkID,TNodeID>* endPtr = ptr + watches.size();
+    bool consistent = true;
+    for ( ; ptr < endPtr; ptr++) {
+        Lazy& lazy = lazyVector[ptr->first];
+        TNodeID* literals = lazyNodeVector.data() + lazy.offset;
+        // Move the watch to an unwatched node not counted, searching round from the last one found
+        TNodeID i = lazy.next;
+        TNodeID left = lazy.size - lazy.watchSize;
+        for ( ; left > 0; left--) {
+            if (stateVector[literals[i] >> 1] != (literals[i] & 1)) break;
+            if (++i == lazy.size) i = lazy.watchSize;
+        }
+        if (left > 0) {
+            std::swap(literals[ptr->second], literals[i]);
+            lazyWatchVector[literals[ptr->second]].push_back(*ptr);
+            lazy.next = i;
+            continue;
+        }
+        // Only watched nodes are left: fire as the counted link would
+        *(keepPtr++) = *ptr;
+        const TLinkID linkID = lazy.linkID;
+        if constexpr (STATISTICS) if (linkID < statistics.linkCountVector.size()) increment(statistics.linkCountVector[linkID]);
+        const TOffset* offsetPtr = problem->linkOffsetArray + 4 * linkID;
+        const TNodeID* linkNodeArray = problem->linkNodeArray;
+        if (!constrain_updateNodeArray(
+                trueNodeIDPtrEnd, falseNodeIDPtrEnd, 
+                linkNodeArray + offsetPtr[2], linkNodeArray + offsetPtr[3], linkNodeArray + offsetPtr[4], 
+                counterVector[linkID].outLimit, problem->rangeArray[linkID] >> 2, linkID)) {
+            conflictLinkID = linkID;
+            increment(statistics.conflictCount);
+            consistent = false;
+            for (ptr++; ptr < endPtr; ptr++) *(keepPtr++) = *ptr;
+            break;
+        }
+    }
+    watches.resize(keepPtr - watches.data());
+    return consistent;
+}
+
+template<typename TNodeID, typename TLinkID>
+bool BasicEngine<TNodeID,TLinkID>::constrain_updateNode(
+    TNodeID*& trueNodeIDPtrEnd, TNodeID*& falseNodeIDPtrEnd, 
+    const TNodeID nodeID, const State state, const TReasonID reasonID) noexcept
+{
+    assert(state == TRUE || state == FALSE);
+    State& nodeState = stateVector[nodeID];
+    if (nodeState == (1 - state)) return false;
+    if (nodeState == MAYBE) {
+        nodeState = state;
+        reasonVector[nodeID] = reasonID;
+        levelVector[nodeID] = level;
+        orderVector[nodeID] = order++;
+        changeMarkVector[nodeID] = changeVector.size();
         if (state == TRUE)
             *(trueNodeIDPtrEnd++) = nodeID;
         else
             *(falseNodeIDPtrEnd--) = nodeID;
     }
     return true;
+}
+
+template<typename TNodeID>
+template<typename TOtherNodeID>
+BasicLink<TNodeID>::BasicLink(const BasicLink<TOtherNodeID>& other)
+    : kind(other.kind), inLimit(other.inLimit), outLimit(other.outLimit),
+      trueOutLen(other.trueOutLen), falseOutLen(other.falseOutLen),
+      trueInLen(other.trueInLen), falseInLen(other.falseInLen)
+{
+    // Callers check fits first: only the ~0 sentinel narrows by wrapping
+    TNodeID outLen = trueOutLen + falseOutLen;
+    TNodeID inLen = trueInLen + falseInLen;
+    outArray = std::make_unique<TNodeID[]>(outLen);
+    inArray = std::make_unique<TNodeID[]>(inLen);
+    std::copy(other.outArray.get(), other.outArray.get() + outLen, outArray.get());
+    std::copy(other.inArray.get(), other.inArray.get() + inLen, inArray.get());
+}
+
+template<typename TNodeID>
+template<typename TOtherNodeID>
+bool BasicLink<TNodeID>::fits() const noexcept
+{
+    // The narrow ~0 is the sentinel, so a real limit must stay below it
+    constexpr TNodeID sentinel = ~TNodeID(0);
+    constexpr TNodeID otherSentinel = TNodeID(TOtherNodeID(~TOtherNodeID(0)));
+    auto fitsLimit = [](TNodeID limit) { return limit < otherSentinel || limit == sentinel; };
+    return fitsLimit(inLimit) && fitsLimit(outLimit);
+}
+
+template<typename TNodeID, typename TLinkID>
+BasicLanes<TNodeID,TLinkID>::BasicLanes(std::shared_ptr<const BasicProblem<TNodeID,TLinkID>> problem)
+    : problem(std::move(problem)),
+      trueVector(BasicLanes::problem->nodeSize, 0), falseVector(BasicLanes::problem->nodeSize, 0),
+      conflictLanes(0),
+      dirtyVector(BasicLanes::problem->linkSize, false),
+      complete(std::all_of(
+          BasicLanes::problem->kindArray, BasicLanes::problem->kindArray + BasicLanes::problem->linkSize,
+          [](Kind kind) { return kind == AT_MOST_ONE || kind == EXACTLY_ONE; })) {}
+
+template<typename TNodeID, typename TLinkID>
+State BasicLanes<TNodeID,TLinkID>::getNodeState(const unsigned int lane, const TNodeID nodeID) const noexcept
+{
+    const TLanes bit = TLanes(1) << lane;
+    return (trueVector[nodeID] & bit) ? TRUE : (falseVector[nodeID] & bit) ? FALSE : MAYBE;
+}
+
+template<typename TNodeID, typename TLinkID>
+void BasicLanes<TNodeID,TLinkID>::getNodeStates(const unsigned int lane, vector<pair<TNodeID,bool>>& nodeStates) const
+{
+    nodeStates.clear();
+    for (TNodeID nodeID = 0; nodeID < trueVector.size(); nodeID++) {
+        const State state = getNodeState(lane, nodeID);
+        if (state != MAYBE) nodeStates.push_back({nodeID, state == TRUE});
+    }
+}
+
+template<typename TNodeID, typename TLinkID>
+typename BasicLanes<TNodeID,TLinkID>::TLanes BasicLanes<TNodeID,TLinkID>::getAssignedLanes() const noexcept
+{
+    TLanes lanes = ~TLanes(0);
+    for (TNodeID nodeID = 0; nodeID < trueVector.size() && lanes != 0; nodeID++)
+        lanes &= trueVector[nodeID] | falseVector[nodeID];
+    return lanes;
+}
+
+template<typename TNodeID, typename TLinkID>
+void BasicLanes<TNodeID,TLinkID>::assign(const unsigned int lane, const TNodeID nodeID, const bool state) noexcept
+{
+    assert(lane < LANE_COUNT);
+    const TLanes bit = TLanes(1) << lane;
+    TLanes& lanes = state ? trueVector[nodeID] : falseVector[nodeID];
+    if (lanes & bit) return;
+    lanes |= bit;
+    if ((trueVector[nodeID] & falseVector[nodeID]) & bit) conflictLanes |= bit;
+    constrain_mark(nodeID);
+}
+
+template<typename TNodeID, typename TLinkID>
+typename BasicLanes<TNodeID,TLinkID>::TLanes BasicLanes<TNodeID,TLinkID>::constrain() noexcept
+{
+    const Kind* kindArray = problem->kindArray;
+    const TOffset* linkOffsetArray = problem->linkOffsetArray;
+    const TNodeID* linkNodeArray = problem->linkNodeArray;
+    for (bool dirty = true; dirty; ) {
+        dirty = false;
+        for (TLinkID linkID = 0; linkID < dirtyVector.size(); linkID++) {
+            if (!dirtyVector[linkID]) continue;
+            dirty = true;
+            const TNodeID* beginPtr = linkNodeArray + linkOffsetArray[4 * linkID + 2];
+            const TNodeID* endPtr = linkNodeArray + linkOffsetArray[4 * linkID + 3];
+            // Lanes with at least one and at least two nodes TRUE, and not FALSE
+            TLanes trueOne = 0, trueTwo = 0, openOne = 0, openTwo = 0;
+            for (const TNodeID* ptr = beginPtr; ptr < endPtr; ptr++) {
+                const TLanes trueLanes = trueVector[*ptr];
+                const TLanes openLanes = ~falseVector[*ptr];
+                trueTwo |= trueOne & trueLanes;
+                trueOne |= trueLanes;
+                openTwo |= openOne & openLanes;
+                openOne |= openLanes;
+            }
+            conflictLanes |= trueTwo;
+            // A TRUE node makes the others FALSE; for exactly one, the last open node is TRUE
+            TLanes loneLanes = 0;
+            if (kindArray[linkID] == EXACTLY_ONE) {
+                conflictLanes |= ~openOne;
+                loneLanes = openOne & ~openTwo;
+            }
+            // Only lanes where that changes a node
+            loneLanes &= ~trueOne & ~conflictLanes;
+            trueOne &= openTwo & ~conflictLanes;
+            // Still marked while updating, the group is not marked again by its own updates
+            if ((trueOne | loneLanes) != 0) {
+                for (const TNodeID* ptr = beginPtr; ptr < endPtr; ptr++) {
+                    const TLanes trueLanes = trueVector[*ptr] | (loneLanes & ~falseVector[*ptr]);
+                    const TLanes falseLanes = falseVector[*ptr] | (trueOne & ~trueVector[*ptr]);
+                    if (trueLanes == trueVector[*ptr] && falseLanes == falseVector[*ptr]) continue;
+                    trueVector[*ptr] = trueLanes;
+                    falseVector[*ptr] = falseLanes;
+                    constrain_mark(*ptr);
+                }
+            }
+            dirtyVector[linkID] = false;
+        }
+    }
+    return conflictLanes;
+}
+
+template<typename TNodeID, typename TLinkID>
+void BasicLanes<TNodeID,TLinkID>::reset() noexcept
+{
+    std::fill(trueVector.begin(), trueVector.end(), 0);
+    std::fill(falseVector.begin(), falseVector.end(), 0);
+    std::fill(dirtyVector.begin(), dirtyVector.end(), false);
+    conflictLanes = 0;
+}
+
+template<typename TNodeID, typename TLinkID>
+inline void BasicLanes<TNodeID,TLinkID>::constrain_mark(const TNodeID nodeID) noexcept
+{
+    // Every group of the node is in its trueGroup segment
+    const TLinkID* ptr = problem->nodeLinkArray + problem->nodeOffsetArray[6 * nodeID + 2];
+    const TLinkID* endPtr = problem->nodeLinkArray + problem->nodeOffsetArray[6 * nodeID + 3];
+    for ( ; ptr < endPtr; ptr++) dirtyVector[*ptr] = true;
+}
+
+template class Imply::BasicLink<unsigned int>;
+template class Imply::BasicProblem<unsigned int, unsigned int>;
+template class Imply::BasicEngine<unsigned int, unsigned int>;
+template class Imply::BasicLink<unsigned short>;
+template class Imply::BasicProblem<unsigned short, unsigned short>;
+template class Imply::BasicEngine<unsigned short, unsigned short>;
+template class Imply::BasicLanes<unsigned int, unsigned int>;
+template class Imply::BasicLanes<unsigned short, unsigned short>;
+template Imply::BasicLink<unsigned short>::BasicLink(const BasicLink<unsigned int>& other);
+template bool Imply::BasicLink<unsigned int>::fits<unsigned short>() const noexcept;
+
+AnyEngine Imply::makeEngine(const vector<Link>& links, TNodeID nodeSize)
+{
+    return makeEngine(vector<Link>(links), nodeSize);
+}
+
+AnyEngine Imply::makeEngine(vector<Link>&& links, TNodeID nodeSize)
+{
+    // Learned literals (2 * nodeID + state) and the heaps' free index bound the compact IDs
+    if (nodeSize < (1 << 15) && links.size() < 0xFFFF &&
+        std::all_of(links.cbegin(), links.cend(), [](const Link& link) { return link.fits<unsigned short>(); })) {
+        vector<Link16> compactLinks;
+        compactLinks.reserve(links.size());
+        for (const Link& link : links) compactLinks.emplace_back(link);
+        return AnyEngine(std::in_place_type<Engine16>, std::move(compactLinks), nodeSize);
+    }
+    return AnyEngine(std::in_place_type<Engine>, std::move(links), nodeSize);
+}
+
+AnyEngine Imply::makeEngine(Kind kind, vector<TNodeID>&& groupNodes, TNodeID groupSize, TNodeID nodeSize)
+{
+    const size_t linkSize = groupNodes.size() / groupSize;
+    if (nodeSize < (1 << 15) && linkSize < 0xFFFF) {
+        vector<unsigned short> compactGroupNodes(groupNodes.cbegin(), groupNodes.cend());
+        groupNodes = vector<TNodeID>();
+        return AnyEngine(std::in_place_type<Engine16>, std::make_shared<const Problem16>(
+            kind, std::move(compactGroupNodes), groupSize, nodeSize));
+    }
+    return AnyEngine(std::in_place_type<Engine>, std::make_shared<const Problem>(
+        kind, std::move(groupNodes), groupSize, nodeSize));
+}
+
+bool Imply::addLinks(AnyEngine& engine, const vector<Link>& links)
+{
+    if (Engine* wideEngine = std::get_if<Engine>(&engine)) return wideEngine->addLinks(links);
+    if (!std::all_of(links.cbegin(), links.cend(), [](const Link& link) { return link.fits<unsigned short>(); }))
+        return false;
+    vector<Link16> compactLinks;
+    compactLinks.reserve(links.size());
+    for (const Link& link : links) compactLinks.emplace_back(link);
+    return std::get<Engine16>(engine).addLinks(compactLinks);
+}
+
+AnyLanes Imply::makeLanes(const AnyEngine& engine)
+{
+    return std::visit([](const auto& engine) -> AnyLanes {
+        typedef std::decay_t<decltype(engine)> TEngine;
+        return BasicLanes<typename TEngine::NodeID, typename TEngine::LinkID>(engine.getProblem());
+    }, engine);
 }
\ No newline at end of file
@@ -1,8 +1,13 @@
+#pragma once
 #include <vector>
 #include <memory>
 #include <iostream>
+#include <functional>
+#include <variant>
+#include <atomic>
+#include <chrono>
+#include "heap.h"
 
-// template<typename TNodeID, typename TLinkID>
 namespace Imply
 {
     using std::vector;
@@ -10,9 +15,18 @@ namespace Imply
     using std::pair;
     typedef unsigned char State;
     typedef unsigned char Side;
+    // Default ID widths; BasicLink, BasicProblem and BasicEngine take their own
     typedef unsigned int TNodeID;
     typedef unsigned int TLinkID;
+    typedef unsigned int TOffset;
+    typedef unsigned int TReasonID;   // Link or learned link IDs, which can outgrow TLinkID
     typedef unsigned char Equality;
+    typedef unsigned char Heuristic;
+    typedef unsigned char Restart;
+    typedef unsigned char Kind;
+    typedef unsigned char Result;
+    typedef unsigned long long TCount;
+    typedef std::function<bool(const vector<State>& stateVector)> TCallback;
     const State FALSE = 0;
     const State TRUE = 1;
     const State MAYBE = 2;
@@ -24,36 +38,75 @@ namespace Imply
     const Equality LT = 0          | 0;
     const Equality GE = IS_GREATER | IS_EQUAL;
     const Equality GT = IS_GREATER | 0;
+    const Heuristic ORDER = 0;      // First MAYBE node by ID
+    const Heuristic SLACK = 1;      // MAYBE node on the link closest to firing
+    const Heuristic ACTIVITY = 2;   // MAYBE node most involved in recent conflicts
+    const Restart NEVER = 0;
+    const Restart LUBY = 1;         // Runs of 1, 1, 2, 1, 1, 2, 4, 1, ... units of conflicts
+    const Restart GEOMETRIC = 2;    // Runs of 1, 1.5, 2.25, ... units of conflicts
+    const Kind GENERIC = 0;         // Conditional cardinality link
+    const Kind AT_MOST_ONE = 1;     // At most one node of the group is TRUE
+    const Kind EXACTLY_ONE = 2;     // Exactly one node of the group is TRUE
+    const Kind LAZY = 3;            // Generic link set aside by the problem, see build
+    const Result UNSAT = 0;
+    const Result SAT = 1;
+    const Result UNKNOWN = 2;       // A limit stopped the search first
+#if defined(IMPLY_STATISTICS)
+    constexpr bool STATISTICS = true;
+#else
+    constexpr bool STATISTICS = false;
+#endif
 
-    class Node
+    // Search counters of an engine. Decisions, conflicts and restarts are always
+    // counted, since limits and restarts run on them, the rest only when built with
+    // IMPLY_STATISTICS. The engine is the only writer, so other threads may read the
+    // counters while it runs; a threaded search merges its workers' counts about
+    // every millisecond, and their link counts when it ends. linkCountVector is replaced by setLinkStatistics, so it may
+    // only be read live between calls to it, and links added later are not counted.
+    struct Statistics
     {
-    private:
-        friend class Engine;
-        State state;
-        TLinkID trueInLen, trueOutLen;
-        unique_ptr<TLinkID[]> trueArray;
-        TLinkID falseInLen, falseOutLen;
-        unique_ptr<TLinkID[]> falseArray;
-    public:
-        Node(const Node& other);
-        Node& operator=(const Node& other);
-        Node(Node&& other) noexcept;
-        Node& operator=(Node&& other) noexcept;
-
-        Node() noexcept;
-        Node(
-            const vector<TLinkID>& trueInLinks,
-            const vector<TLinkID>& trueOutLinks,
-            const vector<TLinkID>& falseInLinks,
-            const vector<TLinkID>& falseOutLinks);
+        std::atomic<TCount> decisionCount;
+        std::atomic<TCount> propagationCount;   // Nodes whose links were visited
+        std::atomic<TCount> conflictCount;
+        std::atomic<TCount> restartCount;
+        std::atomic<TCount> undoLinkCount;      // Links visited by undo
+        std::atomic<TCount> maxTrailDepth;      // Most nodes assigned at once
+        std::atomic<TCount> maxBoundDepth;      // Deepest decision level
+        vector<std::atomic<TCount>> linkCountVector;    // Updates per link, see setLinkStatistics
+
+        Statistics() noexcept;
+        Statistics(const Statistics& other);
+        Statistics& operator=(const Statistics& other);
+        Statistics(Statistics&& other) noexcept;
+        Statistics& operator=(Statistics&& other) noexcept;
+
+        // Adds what a copy counted since it was made from base
+        void add(const Statistics& copy, const Statistics& base) noexcept;
+        // Copies the counters but not linkCountVector
+        void assignCounts(const Statistics& other) noexcept;
+    };
+
+    // Limits of one search, see BasicEngine::solve; none by default. The budgets
+    // count decisions and conflicts from the start of the call, zero for none, and
+    // any thread may set cancel to stop the search.
+    struct Limits
+    {
+        std::chrono::steady_clock::time_point deadline;
+        TCount decisionBudget;
+        TCount conflictBudget;
+        const std::atomic<bool>* cancel;
+
+        Limits() noexcept;
     };
 
-    class Link
+    template<typename TNodeID>
+    class BasicLink
     {
     private:
-        friend class Engine;
-        // Shared
-        TNodeID inCount, outCount;
+        template<typename, typename> friend class BasicProblem;
+        template<typename, typename> friend class BasicEngine;
+        template<typename> friend class BasicLink;
+        Kind kind;
         TNodeID inLimit, outLimit;
         // Conditional
         TNodeID trueOutLen, falseOutLen;
@@ -62,85 +115,464 @@ namespace Imply
         TNodeID trueInLen, falseInLen;
         unique_ptr<TNodeID[]> inArray;
     public:
-        Link(const Link& other);
-        Link& operator=(const Link& other);
-        Link(Link&& other) noexcept;
-        Link& operator=(Link&& other) noexcept;
+        BasicLink(const BasicLink& other);
+        BasicLink& operator=(const BasicLink& other);
+        BasicLink(BasicLink&& other) noexcept;
+        BasicLink& operator=(BasicLink&& other) noexcept;
 
-        Link() noexcept;
-        Link(
+        BasicLink() noexcept;
+        BasicLink(
             const vector<TNodeID>& trueInNodes,
             const vector<TNodeID>& falseInNodes,
             Equality inEquality, TNodeID inLimit,
             const vector<TNodeID>& trueOutNodes,
             const vector<TNodeID>& falseOutNodes,
             Equality outEquality, TNodeID outLimit);
+        BasicLink(Kind kind, const vector<TNodeID>& nodes);
+        template<typename TOtherNodeID>
+        explicit BasicLink(const BasicLink<TOtherNodeID>& other);
+        // Whether both limits survive narrowing to TOtherNodeID
+        template<typename TOtherNodeID>
+        bool fits() const noexcept;
+    };
+
+    class Loader;
+
+    // Links compiled into adjacency arrays; read-only once built, so any
+    // number of engines can share one through a shared_ptr
+    template<typename TNodeID, typename TLinkID>
+    class BasicProblem
+    {
     private:
-        bool isJustConditional() const noexcept;
-        bool isJustContrapositive() const noexcept;
-        bool isJustNotConditional() const noexcept;
-        bool isJustNotContrapositive() const noexcept;
+        template<typename, typename> friend class BasicEngine;
+        template<typename, typename> friend class BasicLanes;
+        friend class Loader;
+        TNodeID nodeSize;
+        TLinkID linkSize;
+        // Nodes: [trueIn | trueOut | trueGroup | falseIn | falseOut | falseGroup] link IDs per node
+        vector<TOffset> nodeOffsetVector;
+        vector<TLinkID> nodeLinkVector;
+        // Links: [trueIn | falseIn | trueOut | falseOut] node IDs per link, a group's nodes as trueOut
+        vector<Kind> kindVector;
+        vector<pair<TNodeID,TNodeID>> limitVector;
+        // Bit k set: link segment k is a run of consecutive node IDs
+        vector<unsigned char> rangeVector;
+        vector<TOffset> linkOffsetVector;
+        vector<TNodeID> linkNodeVector;
+        // What engines read: the vectors above, or a compiled engine file kept alive by storage
+        std::shared_ptr<const void> storage;
+        const TOffset* nodeOffsetArray;
+        const TLinkID* nodeLinkArray;
+        const Kind* kindArray;
+        const pair<TNodeID,TNodeID>* limitArray;
+        const unsigned char* rangeArray;
+        const TOffset* linkOffsetArray;
+        const TNodeID* linkNodeArray;
+    public:
+        BasicProblem(const BasicProblem& other) = delete;
+        BasicProblem& operator=(const BasicProblem& other) = delete;
+
+        BasicProblem(const vector<BasicLink<TNodeID>>& links, TNodeID nodeSize);
+        BasicProblem(vector<BasicLink<TNodeID>>&& links, TNodeID nodeSize);
+        // Groups of one kind and groupSize nodes each, back to back in groupNodes: the
+        // problem of a BasicLink(kind, group) per group, built without the links
+        BasicProblem(Kind kind, vector<TNodeID>&& groupNodes, TNodeID groupSize, TNodeID nodeSize);
+
+        TNodeID getNodeSize() const noexcept { return nodeSize; }
+        TLinkID getLinkSize() const noexcept { return linkSize; }
+    private:
+        // Link rows are filled first, by the constructors or a Loader. Large generic
+        // links without a condition that fire only when few out nodes are left become
+        // LAZY: they get no node rows and engines visit them through watched nodes.
+        BasicProblem() noexcept;
+        void build(TNodeID nodeSize);
     };
 
-    class Engine
+    template<typename TNodeID, typename TLinkID>
+    class BasicEngine
     {
     private:
+        friend class Loader;
         struct Bound
         {
-            friend class Engine;
+            friend class BasicEngine;
             TNodeID* trueNodeIDPtr;
             TNodeID* falseNodeIDPtr;
+            TNodeID nodeID;
+            State nodeState;
             State state;
             Bound() noexcept;
             Bound(TNodeID* trueNodeIDPtr, TNodeID* falseNodeIDPtr, State state) noexcept;
         };
+        // A group counts its TRUE nodes as outCount and its FALSE nodes as inCount
+        struct Counter
+        {
+            TNodeID inCount, outCount;
+            TNodeID inLimit, outLimit;
+            bool isJustConditional() const noexcept;
+            bool isJustContrapositive() const noexcept;
+            TNodeID getSlack() const noexcept;
+            TNodeID getGroupSlack() const noexcept;
+        };
+        typedef unsigned long long TOrder;
+        struct Learn
+        {
+            TOffset offset;
+            TNodeID size;
+            TNodeID glue;
+            double activity;
+            TOrder order;
+        };
+        struct Lazy
+        {
+            TLinkID linkID;
+            TOffset offset;
+            TNodeID size;
+            TNodeID watchSize;  // Out nodes that must not be counted, plus one
+            TNodeID next;       // Where the search for an unwatched node starts
+        };
+        struct Change
+        {
+            TLinkID linkID;
+            TNodeID inCount, outCount;
+        };
+        static constexpr TReasonID DECISION = ~TReasonID(0);
+        static constexpr TNodeID NONE = ~TNodeID(0);
+        struct Split;
+        struct Budget;
+    public:
+        // Trail sizes and search order at a point in time, see rollback
+        struct Checkpoint
+        {
+            TNodeID trueSize, falseSize;
+            TOrder order;
+        };
     private:
-        vector<Node> nodeVector;
-        vector<Link> linkVector;
+        // Shared topology; only the states and counters below belong to this engine
+        std::shared_ptr<const BasicProblem<TNodeID,TLinkID>> problem;
+        vector<State> stateVector;
+        vector<Counter> counterVector;
+        // Counter trail: counts of a problem link before its first change in each stamp,
+        // which every constrain and undo moves on, and per node the trail size when it
+        // was assigned; undo restores these instead of visiting each node's links again
+        vector<Change> changeVector;
+        vector<TOrder> changeStampVector;
+        vector<TOffset> changeMarkVector;
+        TOrder changeStamp;
+        // Links added to this engine, IDs after the problem's: rows as in the problem,
+        // and per literal (2 * nodeID + state) the links it updates and how
+        vector<Kind> addKindVector;
+        vector<unsigned char> addRangeVector;
+        vector<TOffset> addLinkOffsetVector;
+        vector<TNodeID> addLinkNodeVector;
+        vector<vector<pair<TLinkID,Side>>> addNodeLinkVector;
+        // Trail: nodes committed by constrain and backtrack end at the top pointers
         unique_ptr<TNodeID[]> nodeIDArray;
         unique_ptr<Bound[]> boundArray;
+        TNodeID* trueNodeIDPtrTop;
+        TNodeID* falseNodeIDPtrTop;
+        // Heuristic
+        Heuristic heuristic;
+        bool phaseSaving;
+        vector<State> phaseVector;
+        Heap<TNodeID,double,std::greater<double>> activityHeap;
+        double activityIncrement;
+        Heap<TLinkID,TNodeID> slackHeap;
+        vector<pair<TLinkID,TNodeID>> slackParkVector;
+        TReasonID conflictLinkID;
+        // Restarts: the policy, conflicts per unit, runs so far and the conflict count ending this one
+        Restart restart;
+        TCount restartUnit;
+        TCount restartIndex;
+        TCount restartLimit;
+        // Trace: why, at which decision level and in which order each node was assigned
+        vector<TReasonID> reasonVector;
+        vector<TNodeID> levelVector;
+        vector<TOrder> orderVector;
+        TNodeID level;
+        TOrder order;
+        // Learned links: at least one literal (2 * nodeID + state) holds, two watched
+        bool learning;
+        TReasonID learnLimit;
+        double learnIncrement;
+        vector<Learn> learnVector;
+        vector<TNodeID> learnNodeVector;
+        vector<vector<TReasonID>> watchVector;
+        // Lazy links: out nodes as counting literals (2 * nodeID + state), the first
+        // watchSize of a link watched, and per literal the links and positions watching it
+        vector<Lazy> lazyVector;
+        vector<TNodeID> lazyNodeVector;
+        vector<vector<pair<TLinkID,TNodeID>>> lazyWatchVector;
+        // Conflict analysis
+        vector<TNodeID> learnBuffer;
+        TNodeID learnLevel;
+        vector<bool> seenVector;
+        vector<TNodeID> seenNodeVector;
+        vector<pair<TOrder,TNodeID>> analyzeHeap;
+        // Assumptions of solveUnder as literals, decided first at levels 1, 2, ...
+        vector<TNodeID> assumeVector;
+        // Parallel: shared work of the search, this worker's subproblem, lowest bound that may be open
+        Split* split;
+        vector<pair<TNodeID,bool>> splitPath;
+        TNodeID splitDepth;
+        // Search stopped by its limits: the bound it stopped at, NONE if there is none,
+        // and what a threaded one left as subproblems, see solve
+        TNodeID resumeDepth;
+        vector<vector<pair<TNodeID,bool>>> resumePathVector;
+        Statistics statistics;
     public:
-        Engine() noexcept;
-        Engine(const Engine& other);
-        Engine& operator=(const Engine& other);
-        Engine(Engine&& other) noexcept;
-        Engine& operator=(Engine&& other) noexcept;
+        typedef TNodeID NodeID;
+        typedef TLinkID LinkID;
+
+        BasicEngine() noexcept;
+        BasicEngine(const BasicEngine& other);
+        BasicEngine& operator=(const BasicEngine& other);
+        BasicEngine(BasicEngine&& other) noexcept;
+        BasicEngine& operator=(BasicEngine&& other) noexcept;
+
+        BasicEngine(const vector<BasicLink<TNodeID>>& links, TNodeID nodeSize);
+        BasicEngine(vector<BasicLink<TNodeID>>&& links, TNodeID nodeSize);
+        BasicEngine(std::shared_ptr<const BasicProblem<TNodeID,TLinkID>> problem);
+
+        const std::shared_ptr<const BasicProblem<TNodeID,TLinkID>>& getProblem() const noexcept { return problem; }
 
-        Engine(const vector<Link>& links, TNodeID nodeSize);
-        Engine(vector<Link>&& links, TNodeID nodeSize);
+        TNodeID getNodeSize() const noexcept { return stateVector.size(); }
+        TLinkID getLinkSize() const noexcept { return counterVector.size(); }
+        State getNodeState(TNodeID nodeID) const noexcept { return stateVector[nodeID]; }
+        Heuristic getHeuristic() const noexcept { return heuristic; }
+        TReasonID getLearnSize() const noexcept { return learnVector.size(); }
+        const Statistics& getStatistics() const noexcept { return statistics; }
+        bool isSuspended() const noexcept { return resumeDepth != NONE || !resumePathVector.empty(); }
 
-        State getNodeState(TNodeID nodeID) const noexcept { return nodeVector[nodeID].state; }
+        void setHeuristic(Heuristic heuristic, bool phaseSaving = false);
+        void setLearning(bool learning, TReasonID learnLimit = 1 << 14);
+        // Restarts unwind the search to the first decision past any assumptions each
+        // time a run reaches its conflicts; runs grow, so the search stays complete.
+        // Learned links, activities and saved phases carry over to the next run, so
+        // restarts pair with ACTIVITY and phase saving. Without learning a restart
+        // also forgets which branches failed, and enumerate, count and threads do
+        // not restart.
+        void setRestarts(Restart restart, TCount unit = 100);
+        // Counts updates per link from now on, from zero; see Statistics
+        void setLinkStatistics(bool enabled);
 
+        // Adds links to the engine as it stands, after the problem's links: their
+        // counters start from the current states and whatever they imply is propagated
+        // at once. On a conflict, or when the link IDs would outgrow TLinkID, nothing
+        // is added and the states are unchanged.
+        // The shared problem is untouched, so getProblem() does not have them.
+        bool addLink(const BasicLink<TNodeID>& link);
+        bool addLinks(const vector<BasicLink<TNodeID>>& links);
         bool constrain(const vector<pair<TNodeID,bool>>& nodeStates) noexcept;
         bool constrain(const vector<TNodeID>& trueNodeIDs, const vector<TNodeID>& falseNodeIDs) noexcept;
         bool backtrack() noexcept;
+        bool backtrack(unsigned int threadCount);
+        // Backtracks as backtrack(threadCount) does until a limit stops it. Limits are
+        // checked before each decision, the clock at the first and every 64th; when
+        // threaded, by this thread about every millisecond. On UNKNOWN the search is
+        // suspended where it stopped, its decisions still assigned, and the next solve
+        // goes on from there with any thread count; threads leave what they had not
+        // searched as subproblems, without the links they learned. Every other call
+        // that changes states, or the heuristic or learning, drops it first and
+        // starts from the states before it.
+        Result solve(const Limits& limits, unsigned int threadCount = 1);
+        TCount enumerate(const TCallback& callback, TCount limit = 0);
+        TCount count(TCount limit = 0);
+        // Searches with the assumptions as the first decisions, which are never flipped,
+        // and leaves the states as they were; learned links are kept for later calls.
+        // On success model holds the solution. Otherwise core holds assumptions that
+        // cannot all hold, empty if the states alone have no solution: found by conflict
+        // analysis when learning, else by propagation or, failing that, as every
+        // assumption decided when the search ran out.
+        bool solveUnder(
+            const vector<pair<TNodeID,bool>>& assumptions, 
+            vector<pair<TNodeID,bool>>& core, vector<State>& model);
+        // Failed-literal probing before a search: tries each MAYBE node TRUE and then
+        // FALSE, fixing it when one side fails and fixing any node both sides imply
+        // alike, round after round until one fixes nothing. Threads probe their own
+        // copies of the engine, each a share of the nodes, and their findings are
+        // fixed here after each round. A budget of seconds, if given, ends probing
+        // early with what was found. Returns false if the states have no solution.
+        bool probe(unsigned int threadCount = 1, double seconds = 0);
+
+        Checkpoint checkpoint() const noexcept;
+        void rollback(const Checkpoint& checkpoint) noexcept;
+        void reset() noexcept;
     private:
+        void copyBoundArray(const BasicEngine& other) noexcept;
+        // Link rows of the problem's links, then of the added links
+        const TOffset* getLinkOffsets(TLinkID linkID) const noexcept;
+        const TNodeID* getLinkNodes(TLinkID linkID) const noexcept;
+        Kind getLinkKind(TLinkID linkID) const noexcept;
+        unsigned char getLinkRanges(TLinkID linkID) const noexcept;
+        // Add
+        bool addLinks(const BasicLink<TNodeID>* ptr, const BasicLink<TNodeID>* endPtr);
+        bool addLinks_fire(TNodeID*& trueNodeIDPtrEnd, TNodeID*& falseNodeIDPtrEnd, TLinkID linkID) noexcept;
+        void addLinks_remove(TLinkID linkID) noexcept;
+        void addLinks_shiftReasons(TLinkID linkID, long long shift) noexcept;
         // Backtrack
-        bool backtrack_findMaybe(TNodeID& nodeID) noexcept;
+        Result backtrack(const TCallback* callback, TCount limit, TCount& count, const Budget* budget = nullptr);
+        Result backtrack(unsigned int threadCount, const Budget& budget);
+        void backtrack_clear(const Bound* boundPtr) noexcept;
+        void backtrack_abandon() noexcept;
+        void backtrack_open(const Bound* boundPtr, vector<vector<pair<TNodeID,bool>>>& pathVector) const;
+        bool backtrack_block(Bound*& boundPtr, TNodeID& nodeID) noexcept;
+        bool backtrack_findMaybe(TNodeID& nodeID, State& nodeState, TNodeID depth) noexcept;
+        bool backtrack_findOrder(TNodeID& nodeID) noexcept;
+        bool backtrack_findActivity(TNodeID& nodeID) noexcept;
+        bool backtrack_findSlack(TNodeID& nodeID, State& nodeState, TNodeID depth) noexcept;
+        bool backtrack_findSlack(
+            TNodeID& nodeID, State& nodeState, const TNodeID* linkNodeArray,
+            TOffset offset, TOffset midOffset, TOffset endOffset) const noexcept;
+        void backtrack_unpark(TNodeID depth) noexcept;
+        void backtrack_bump(TLinkID linkID) noexcept;
+        void backtrack_bumpNode(TNodeID nodeID) noexcept;
+        void backtrack_updateSlack(TLinkID linkID) noexcept;
+        void backtrack_commit(const Bound* boundPtr) noexcept;
+        void backtrack_restart(Bound*& boundPtr, TNodeID& nodeID) noexcept;
+        void backtrack_schedule() noexcept;
+        bool backtrack_assume(Bound*& boundPtr, TNodeID& nodeID) noexcept;
+        // Learn
+        bool backtrack_learn(Bound*& boundPtr, TNodeID& nodeID) noexcept;
+        void backtrack_analyze() noexcept;
+        void backtrack_analyzeConflict() noexcept;
+        void backtrack_analyzeFinal(TNodeID nodeID) noexcept;
+        void backtrack_analyzeReason(TReasonID reasonID, TOrder orderLimit, TNodeID nodeID) noexcept;
+        void backtrack_analyzeNode(TNodeID nodeID) noexcept;
+        TReasonID backtrack_store() noexcept;
+        void backtrack_reduce() noexcept;
+        void backtrack_watch() noexcept;
+        void backtrack_forget(TOrder order) noexcept;
+        bool backtrack_isLocked(TReasonID learnID) const noexcept;
+        void backtrack_jump(Bound*& boundPtr, TNodeID& nodeID, TNodeID depth) noexcept;
+        bool backtrack_assert(Bound*& boundPtr, TNodeID nodeID, TNodeID literal, TReasonID reasonID) noexcept;
+        // Parallel
+        void backtrack_work(const BasicEngine& root);
+        void backtrack_restore(const BasicEngine& root);
+        bool backtrack_split(Bound*& boundPtr, TNodeID& nodeID);
+        // Probe
+        bool probe_round(
+            TNodeID nodeID, TNodeID step, std::chrono::steady_clock::time_point deadline, 
+            vector<pair<TNodeID,bool>>& facts) noexcept;
+        bool probe_fix(const pair<TNodeID,bool>* ptr, const pair<TNodeID,bool>* endPtr) noexcept;
         // Constrain & Undo
         bool constrain(
             TNodeID* trueNodeIDPtrStart, TNodeID* falseNodeIDPtrStart, 
             TNodeID*& trueNodeIDPtrEnd, TNodeID*& falseNodeIDPtrEnd) noexcept;
+        void constrain_watch() noexcept;
         void undo(
             TNodeID* trueNodeIDPtrStart, TNodeID* trueNodeIDPtrMid, TNodeID* trueNodeIDPtrEnd, 
             TNodeID* falseNodeIDPtrStart, TNodeID* falseNodeIDPtrMid, TNodeID* falseNodeIDPtrEnd) noexcept;
+        void undo_restore(TOffset mark) noexcept;
+        void undo_updateNode(TNodeID nodeID) noexcept;
+        void undo_updateLinkArray(TNodeID nodeID, State state) noexcept;
+        void undo_updateAddArray(const pair<TLinkID,Side>* ptr, const pair<TLinkID,Side>* endPtr, State state) noexcept;
         bool constrain_updateLinkArray(
             TNodeID*& trueNodeIDPtrEnd, TNodeID*& falseNodeIDPtrEnd, 
-            const Node& node, State state, bool reset, bool propagate) noexcept;
-        bool constrain_updateLinkArray(
+            TNodeID nodeID, State state) noexcept;
+        void constrain_change(TLinkID linkID) noexcept;
+        bool constrain_updateLearnArray(
+            TNodeID*& trueNodeIDPtrEnd, TNodeID*& falseNodeIDPtrEnd, 
+            TNodeID nodeID, State state) noexcept;
+        bool constrain_updateLazyArray(
             TNodeID*& trueNodeIDPtrEnd, TNodeID*& falseNodeIDPtrEnd, 
-            const unique_ptr<TLinkID[]>& nodeArray, TLinkID inLen, TLinkID outLen, bool reset, bool propagate) noexcept;
+            TNodeID nodeID, State state) noexcept;
         bool constrain_updateLink(
             TNodeID*& trueNodeIDPtrEnd, TNodeID*& falseNodeIDPtrEnd, 
-            TLinkID linkID, Side side, bool reset, bool propagate) noexcept;
-        bool constrain_updateNodeArray(
+            TLinkID linkID, Side side) noexcept;
+        bool constrain_updateGroup(
             TNodeID*& trueNodeIDPtrEnd, TNodeID*& falseNodeIDPtrEnd, 
-            const Link& link, bool reset) noexcept;
+            TLinkID linkID, State state) noexcept;
         bool constrain_updateNodeArray(
             TNodeID*& trueNodeIDPtrEnd, TNodeID*& falseNodeIDPtrEnd, 
-            const unique_ptr<TNodeID[]>& linkArray, TNodeID trueLen, TNodeID falseLen, TNodeID exLimit, bool reset) noexcept;
+            const TNodeID* ptr, const TNodeID* truePtr, const TNodeID* falsePtr, TNodeID exLimit,
+            unsigned char ranges, TReasonID reasonID) noexcept;
+        bool constrain_updateNodeRange(
+            TNodeID*& trueNodeIDPtrEnd, TNodeID*& falseNodeIDPtrEnd, 
+            TNodeID nodeID, TNodeID size, State state, TNodeID& count, TNodeID exLimit,
+            TReasonID reasonID) noexcept;
         bool constrain_updateNode(
             TNodeID*& trueNodeIDPtrEnd, TNodeID*& falseNodeIDPtrEnd, 
-            TNodeID nodeID, State state, bool reset) noexcept;
+            TNodeID nodeID, State state, TReasonID reasonID) noexcept;
+    };
+
+    // Up to 64 instances of one problem, a lane each, propagated together: a node
+    // keeps a word of the lanes where it is TRUE and one where it is FALSE, so a visit
+    // to a group updates every lane in a few word operations. Only AT_MOST_ONE and
+    // EXACTLY_ONE links are propagated, which is sound but leaves the other links, and
+    // the search, to an engine that takes a lane over from getNodeStates.
+    template<typename TNodeID, typename TLinkID>
+    class BasicLanes
+    {
+    public:
+        typedef unsigned long long TLanes;
+        typedef TNodeID NodeID;
+        static constexpr unsigned int LANE_COUNT = 64;
+    private:
+        std::shared_ptr<const BasicProblem<TNodeID,TLinkID>> problem;
+        vector<TLanes> trueVector;
+        vector<TLanes> falseVector;
+        TLanes conflictLanes;
+        // Groups with a node changed since their last visit; sweeps visit them in ID
+        // order until none is left, which takes far fewer visits than a queue when
+        // every lane changes nodes at its own pace
+        vector<bool> dirtyVector;
+        bool complete;
+    public:
+        BasicLanes(const BasicLanes& other) = default;
+        BasicLanes& operator=(const BasicLanes& other) = default;
+        BasicLanes(BasicLanes&& other) = default;
+        BasicLanes& operator=(BasicLanes&& other) = default;
+
+        BasicLanes(std::shared_ptr<const BasicProblem<TNodeID,TLinkID>> problem);
+
+        // Every link is a group, so a lane without a conflict and a MAYBE node is solved
+        bool isComplete() const noexcept { return complete; }
+        TNodeID getNodeSize() const noexcept { return trueVector.size(); }
+        TLanes getTrueLanes(TNodeID nodeID) const noexcept { return trueVector[nodeID]; }
+        TLanes getFalseLanes(TNodeID nodeID) const noexcept { return falseVector[nodeID]; }
+        State getNodeState(unsigned int lane, TNodeID nodeID) const noexcept;
+        void getNodeStates(unsigned int lane, vector<pair<TNodeID,bool>>& nodeStates) const;
+        TLanes getConflictLanes() const noexcept { return conflictLanes; }
+        TLanes getAssignedLanes() const noexcept;
+
+        // Assigns nodes lane by lane, then propagates all lanes at once; returns the
+        // lanes with a conflict so far, which propagation leaves as they are
+        void assign(unsigned int lane, TNodeID nodeID, bool state) noexcept;
+        TLanes constrain() noexcept;
+        void reset() noexcept;
+    private:
+        void constrain_mark(TNodeID nodeID) noexcept;
     };
+
+    typedef BasicLink<unsigned int> Link;
+    typedef BasicProblem<unsigned int, unsigned int> Problem;
+    typedef BasicEngine<unsigned int, unsigned int> Engine;
+    // Compact IDs for problems under 2^15 nodes and 2^16 - 1 links
+    typedef BasicLink<unsigned short> Link16;
+    typedef BasicProblem<unsigned short, unsigned short> Problem16;
+    typedef BasicEngine<unsigned short, unsigned short> Engine16;
+    typedef std::variant<Engine16, Engine> AnyEngine;
+    typedef BasicLanes<unsigned int, unsigned int> Lanes;
+    typedef BasicLanes<unsigned short, unsigned short> Lanes16;
+    typedef std::variant<Lanes16, Lanes> AnyLanes;
+
+    extern template class BasicLink<unsigned int>;
+    extern template class BasicProblem<unsigned int, unsigned int>;
+    extern template class BasicEngine<unsigned int, unsigned int>;
+    extern template class BasicLink<unsigned short>;
+    extern template class BasicProblem<unsigned short, unsigned short>;
+    extern template class BasicEngine<unsigned short, unsigned short>;
+    extern template class BasicLanes<unsigned int, unsigned int>;
+    extern template class BasicLanes<unsigned short, unsigned short>;
+
+    // Engine with the narrowest IDs that fit the problem
+    AnyEngine makeEngine(const vector<Link>& links, TNodeID nodeSize);
+    AnyEngine makeEngine(vector<Link>&& links, TNodeID nodeSize);
+    AnyEngine makeEngine(Kind kind, vector<TNodeID>&& groupNodes, TNodeID groupSize, TNodeID nodeSize);
+    // Adds links to an engine from makeEngine, as BasicEngine::addLinks; also false,
+    // with the engine unchanged, when a limit does not fit the engine's IDs
+    bool addLinks(AnyEngine& engine, const vector<Link>& links);
+    // Lanes over the problem of an engine, in its ID widths
+    AnyLanes makeLanes(const AnyEngine& engine);
 };
\ No newline at end of file
@@ -0,0 +1,613 @@
+#include <string>
+#include <string_view>
+#include <memory>
+#include <vector>
+#include <algorithm>
+#include <variant>
+#include <fstream>
+#include <cstdio>
+#include <cstring>
+#include <climits>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "load.h"
+using std::vector;
+using std::string;
+using namespace Imply;
+
+// Compiled engine file: the header, then the problem's arrays and the engine's
+// states, counters, trail and counter trail, each section padded to a multiple of 8 bytes.
+// Bump ENGINE_VERSION whenever a section or its layout in memory changes.
+static const char ENGINE_MAGIC[8] = {'I', 'M', 'P', 'L', 'Y', 'E', 'N', 'G'};
+static const unsigned int ENGINE_VERSION = 4;
+static const unsigned int ENGINE_BYTE_ORDER = 0x01020304;
+
+struct EngineHeader
+{
+    char magic[8];
+    unsigned int version;
+    unsigned int byteOrder;
+    unsigned char nodeIDSize, linkIDSize, offsetSize, reasonIDSize;
+    unsigned int reserved;
+    unsigned long long nodeSize, linkSize;
+    unsigned long long nodeLinkSize, linkNodeSize;
+    unsigned long long trueSize, falseSize;
+    unsigned long long order;
+    unsigned long long changeSize;
+    unsigned long long checksum;    // Of the sections, see hashWords
+};
+
+static size_t padSize(const size_t size) noexcept
+{
+    return (size + 7) & ~size_t(7);
+}
+
+// Hash of data a word at a time, the last one padded with zeros as it is written
+static unsigned long long hashWords(unsigned long long hash, const char* data, const size_t size) noexcept
+{
+    for (size_t i = 0; i < size; i += 8) {
+        unsigned long long word = 0;
+        std::memcpy(&word, data + i, std::min<size_t>(8, size - i));
+        hash = (hash ^ word) * 0x100000001b3ULL;
+        hash ^= hash >> 29;
+    }
+    return hash;
+}
+
+static const unsigned long long HASH_BASIS = 0xcbf29ce484222325ULL;
+
+// Most nodes a loaded problem may have: build() lays out 6 node segments per node,
+// and 6 * nodeSize + 1 offsets must fit TOffset
+static const long long MAX_NODE_SIZE = (TOffset(~TOffset(0)) - 1) / 6;
+
+// Read-only mapping of a whole file
+class Loader::MappedFile
+{
+private:
+    const char* data;
+    size_t size;
+    bool opened;
+public:
+    MappedFile(const MappedFile& other) = delete;
+    MappedFile& operator=(const MappedFile& other) = delete;
+
+    MappedFile(const string& path, int advice) noexcept;
+    ~MappedFile();
+
+    bool isOpen() const noexcept { return opened; }
+    size_t getSize() const noexcept { return size; }
+    const char* begin() const noexcept { return data; }
+    const char* end() const noexcept { return data + size; }
+};
+
+Loader::MappedFile::MappedFile(const string& path, const int advice) noexcept
+    : data(nullptr), size(0), opened(false)
+{
+    const int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0) return;
+    struct stat status;
+    if (fstat(fd, &status) == 0) {
+        size = status.st_size;
+        // An empty file cannot be mapped
+        void* map = size > 0 ? mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0) : nullptr;
+        if (map != MAP_FAILED) {
+            if (map != nullptr) madvise(map, size, advice);
+            data = static_cast<const char*>(map);
+            opened = true;
+        }
+    }
+    close(fd);
+}
+
+Loader::MappedFile::~MappedFile()
+{
+    if (data != nullptr) munmap(const_cast<char*>(data), size);
+}
+
+bool Loader::loadCNF(const string& path, std::shared_ptr<const Problem>& problem)
+{
+    MappedFile file(path, MADV_SEQUENTIAL);
+    if (!file.isOpen()) return false;
+    Loader loader(file.begin(), file.end());
+    if (!loader.readCNF()) return false;
+    problem = loader.finish();
+    return problem != nullptr;
+}
+
+bool Loader::loadOPB(const string& path, std::shared_ptr<const Problem>& problem)
+{
+    MappedFile file(path, MADV_SEQUENTIAL);
+    if (!file.isOpen()) return false;
+    Loader loader(file.begin(), file.end());
+    if (!loader.readOPB()) return false;
+    problem = loader.finish();
+    return problem != nullptr;
+}
+
+Loader::Loader(const char* ptr, const char* endPtr)
+    : ptr(ptr), endPtr(endPtr), problem(new Problem()), nodeSize(0), contradiction(false),
+      trueNodeIDs(), falseNodeIDs()
+{
+    problem->linkOffsetVector.push_back(0);
+}
+
+bool Loader::readCNF()
+{
+    // p cnf <variables> <clauses>, then clauses as literals ending with 0
+    bool header = false;
+    long long literal;
+    while (true) {
+        skipSpace();
+        if (ptr == endPtr || *ptr == '%') break;
+        if (*ptr == 'c') {
+            skipLine();
+            continue;
+        }
+        if (*ptr == 'p') {
+            ptr++;
+            long long variableCount, clauseCount;
+            if (header || !readWord("cnf") || !readInteger(variableCount) || !readInteger(clauseCount)) return false;
+            if (variableCount < 0 || variableCount > MAX_NODE_SIZE || clauseCount < 0) return false;
+            header = true;
+            nodeSize = variableCount;
+            problem->kindVector.reserve(clauseCount);
+            problem->limitVector.reserve(clauseCount);
+            problem->linkOffsetVector.reserve(4 * clauseCount + 1);
+            continue;
+        }
+        if (!header) return false;
+        trueNodeIDs.clear();
+        falseNodeIDs.clear();
+        while (true) {
+            if (!readInteger(literal)) return false;
+            if (literal == 0) break;
+            const long long variable = literal > 0 ? literal : -literal;
+            if (variable > nodeSize) return false;
+            (literal > 0 ? trueNodeIDs : falseNodeIDs).push_back(variable - 1);
+        }
+        if (!addLink(GE, 1)) return false;
+    }
+    return header;
+}
+
+bool Loader::readOPB()
+{
+    // Constraints as [+-]1 [~]x<k> terms, then >=, <= or =, the degree and ;
+    // A term -x is ~x - 1, so the terms become literals and the degree moves
+    long long constraintCount = 0, variable, coefficient, degree;
+    while (true) {
+        skipSpace();
+        if (ptr == endPtr) break;
+        if (*ptr == '*') {
+            // Optional header: * #variable= <n> #constraint= <m>
+            const char* lineEndPtr = std::find(ptr, endPtr, '\n');
+            const std::string_view line(ptr, lineEndPtr - ptr);
+            const size_t variablePos = line.find("#variable=");
+            const size_t constraintPos = line.find("#constraint=");
+            if (variablePos != std::string_view::npos) {
+                ptr += variablePos + 10;
+                if (readInteger(variable) && variable > 0) {
+                    if (variable > MAX_NODE_SIZE) return false;
+                    nodeSize = std::max<TNodeID>(nodeSize, variable);
+                }
+            }
+            if (constraintPos != std::string_view::npos) {
+                ptr = line.data() + constraintPos + 12;
+                if (readInteger(constraintCount) && constraintCount > 0) {
+                    problem->kindVector.reserve(constraintCount);
+                    problem->limitVector.reserve(constraintCount);
+                    problem->linkOffsetVector.reserve(4 * constraintCount + 1);
+                }
+            }
+            ptr = lineEndPtr;
+            continue;
+        }
+        if (readWord("min:") || readWord("max:")) {
+            // No objective in Imply
+            ptr = std::find(ptr, endPtr, ';');
+            if (ptr == endPtr) return false;
+            ptr++;
+            continue;
+        }
+        trueNodeIDs.clear();
+        falseNodeIDs.clear();
+        degree = 0;
+        while (true) {
+            skipSpace();
+            if (ptr == endPtr) return false;
+            if (*ptr == '>' || *ptr == '<' || *ptr == '=') break;
+            coefficient = 1;
+            if (*ptr != 'x' && *ptr != '~' && !readInteger(coefficient)) return false;
+            if (coefficient != 1 && coefficient != -1) return false;
+            skipSpace();
+            bool negated = ptr < endPtr && *ptr == '~';
+            if (negated) ptr++;
+            if (ptr == endPtr || *ptr != 'x') return false;
+            ptr++;
+            if (!readInteger(variable) || variable < 1 || variable > MAX_NODE_SIZE) return false;
+            if (coefficient < 0) {
+                negated = !negated;
+                degree++;
+            }
+            (negated ? falseNodeIDs : trueNodeIDs).push_back(variable - 1);
+            nodeSize = std::max<TNodeID>(nodeSize, variable);
+        }
+        const bool isGreater = readWord(">=");
+        const bool isLess = !isGreater && readWord("<=");
+        if (!isGreater && !isLess && !readWord("=")) return false;
+        long long rhs;
+        if (!readInteger(rhs) || !readWord(";") || rhs > LLONG_MAX - degree) return false;
+        degree += rhs;
+        if (!isLess && !addLink(GE, degree)) return false;
+        if (!isGreater && !addLink(LE, degree)) return false;
+    }
+    return true;
+}
+
+void Loader::skipSpace() noexcept
+{
+    while (ptr < endPtr && (*ptr == ' ' || *ptr == '\n' || *ptr == '\t' || *ptr == '\r')) ptr++;
+}
+
+void Loader::skipLine() noexcept
+{
+    ptr = std::find(ptr, endPtr, '\n');
+}
+
+bool Loader::readInteger(long long& value) noexcept
+{
+    skipSpace();
+    bool negative = false;
+    if (ptr < endPtr && (*ptr == '-' || *ptr == '+')) negative = *(ptr++) == '-';
+    if (ptr == endPtr || *ptr < '0' || *ptr > '9') return false;
+    value = 0;
+    for ( ; ptr < endPtr && *ptr >= '0' && *ptr <= '9'; ptr++) {
+        // A number past the range of long long is not a file we can represent
+        const int digit = *ptr - '0';
+        if (value > (LLONG_MAX - digit) / 10) return false;
+        value = 10 * value + digit;
+    }
+    if (negative) value = -value;
+    return true;
+}
+
+bool Loader::readWord(const char* word) noexcept
+{
+    skipSpace();
+    const char* wordPtr = ptr;
+    for ( ; *word != '\0'; word++, wordPtr++)
+        if (wordPtr == endPtr || *wordPtr != *word) return false;
+    ptr = wordPtr;
+    return true;
+}
+
+bool Loader::addLink(const Equality equality, const long long limit)
+{
+    // At least limit literals hold: at most size - limit of them fail
+    const long long size = trueNodeIDs.size() + falseNodeIDs.size();
+    if (equality == GE) {
+        if (limit <= 0) return true;
+        if (limit > size) contradiction = true;
+        else return addLink(falseNodeIDs, trueNodeIDs, size - limit);
+    } else {
+        if (limit >= size) return true;
+        if (limit < 0) contradiction = true;
+        else return addLink(trueNodeIDs, falseNodeIDs, limit);
+    }
+    return true;
+}
+
+bool Loader::addLink(const vector<TNodeID>& trueOutNodeIDs, const vector<TNodeID>& falseOutNodeIDs, const TNodeID outLimit)
+{
+    // [trueIn | falseIn | trueOut | falseOut]; the empty condition always holds
+    vector<TNodeID>& linkNodeVector = problem->linkNodeVector;
+    vector<TOffset>& linkOffsetVector = problem->linkOffsetVector;
+    // Every literal's offset, and every link's ID, must fit
+    const size_t size = trueOutNodeIDs.size() + falseOutNodeIDs.size();
+    if (size > TOffset(~TOffset(0)) - linkNodeVector.size()) return false;
+    if (problem->limitVector.size() + 1 >= TLinkID(~TLinkID(0))) return false;
+    linkOffsetVector.push_back(linkNodeVector.size());
+    linkOffsetVector.push_back(linkNodeVector.size());
+    linkNodeVector.insert(linkNodeVector.end(), trueOutNodeIDs.cbegin(), trueOutNodeIDs.cend());
+    linkOffsetVector.push_back(linkNodeVector.size());
+    linkNodeVector.insert(linkNodeVector.end(), falseOutNodeIDs.cbegin(), falseOutNodeIDs.cend());
+    linkOffsetVector.push_back(linkNodeVector.size());
+    problem->kindVector.push_back(GENERIC);
+    problem->limitVector.push_back({~TNodeID(0), outLimit});
+    return true;
+}
+
+std::shared_ptr<const Problem> Loader::finish()
+{
+    // A constraint no assignment meets: node 0 must be both TRUE and FALSE
+    if (contradiction) {
+        nodeSize = std::max<TNodeID>(nodeSize, 1);
+        trueNodeIDs.assign(1, 0);
+        falseNodeIDs.clear();
+        if (!addLink(GE, 1) || !addLink(LE, 0)) return nullptr;
+    }
+    problem->build(nodeSize);
+    return problem;
+}
+
+template<typename TNodeID, typename TLinkID>
+bool Loader::saveEngine(const string& path, const BasicEngine<TNodeID,TLinkID>& engine)
+{
+    typedef BasicEngine<TNodeID,TLinkID> TEngine;
+    if (engine.isSuspended()) return false;
+    const std::shared_ptr<const BasicProblem<TNodeID,TLinkID>> problemPtr =
+        engine.addKindVector.empty() ? engine.problem : mergeLinks(engine);
+    const BasicProblem<TNodeID,TLinkID>& problem = *problemPtr;
+    const unsigned long long nodeSize = problem.nodeSize;
+    const unsigned long long linkSize = problem.linkSize;
+    const TNodeID* nodeIDArray = engine.nodeIDArray.get();
+
+    EngineHeader header;
+    std::memset(&header, 0, sizeof(header));
+    std::memcpy(header.magic, ENGINE_MAGIC, sizeof(header.magic));
+    header.version = ENGINE_VERSION;
+    header.byteOrder = ENGINE_BYTE_ORDER;
+    header.nodeIDSize = sizeof(TNodeID);
+    header.linkIDSize = sizeof(TLinkID);
+    header.offsetSize = sizeof(TOffset);
+    header.reasonIDSize = sizeof(TReasonID);
+    header.nodeSize = nodeSize;
+    header.linkSize = linkSize;
+    header.nodeLinkSize = problem.nodeOffsetArray[6 * nodeSize];
+    header.linkNodeSize = problem.linkOffsetArray[4 * linkSize];
+    header.trueSize = engine.trueNodeIDPtrTop - nodeIDArray;
+    header.falseSize = (nodeIDArray + nodeSize - 1) - engine.falseNodeIDPtrTop;
+    header.order = engine.order;
+    header.changeSize = engine.changeVector.size();
+    // Learned links are not saved, so nodes they forced read as decisions, as when one is dropped
+    vector<TReasonID> reasonVector(engine.reasonVector.cbegin(), engine.reasonVector.cbegin() + nodeSize);
+    for (TReasonID& reasonID : reasonVector)
+        if (reasonID != TEngine::DECISION && reasonID >= linkSize) reasonID = TEngine::DECISION;
+
+    // Written beside the target and renamed over it, so no reader maps half a file
+    const string tempPath = path + ".tmp";
+    std::ofstream stream(tempPath, std::ios::binary | std::ios::trunc);
+    if (!stream) return false;
+    unsigned long long checksum = HASH_BASIS;
+    auto write = [&stream, &checksum](const void* data, const size_t size) {
+        static const char padding[8] = {};
+        if (size > 0) stream.write(static_cast<const char*>(data), size);
+        stream.write(padding, padSize(size) - size);
+        checksum = hashWords(checksum, static_cast<const char*>(data), size);
+    };
+    // The header is written again at the end with the checksum of the sections
+    write(&header, sizeof(header));
+    checksum = HASH_BASIS;
+    write(problem.nodeOffsetArray, (6 * nodeSize + 1) * sizeof(TOffset));
+    write(problem.nodeLinkArray, header.nodeLinkSize * sizeof(TLinkID));
+    write(problem.kindArray, linkSize * sizeof(Kind));
+    write(problem.limitArray, linkSize * sizeof(pair<TNodeID,TNodeID>));
+    write(problem.rangeArray, linkSize * sizeof(unsigned char));
+    write(problem.linkOffsetArray, (4 * linkSize + 1) * sizeof(TOffset));
+    write(problem.linkNodeArray, header.linkNodeSize * sizeof(TNodeID));
+    write(engine.stateVector.data(), nodeSize * sizeof(State));
+    write(engine.counterVector.data(), linkSize * sizeof(typename TEngine::Counter));
+    write(nodeIDArray, nodeSize * sizeof(TNodeID));
+    write(reasonVector.data(), nodeSize * sizeof(TReasonID));
+    write(engine.levelVector.data(), nodeSize * sizeof(TNodeID));
+    write(engine.orderVector.data(), nodeSize * sizeof(typename TEngine::TOrder));
+    write(engine.changeVector.data(), header.changeSize * sizeof(typename TEngine::Change));
+    write(engine.changeMarkVector.data(), nodeSize * sizeof(TOffset));
+    header.checksum = checksum;
+    stream.seekp(0);
+    stream.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    stream.close();
+    if (!stream || std::rename(tempPath.c_str(), path.c_str()) != 0) {
+        std::remove(tempPath.c_str());
+        return false;
+    }
+    return true;
+}
+
+template<typename TNodeID, typename TLinkID>
+std::shared_ptr<const BasicProblem<TNodeID,TLinkID>> Loader::mergeLinks(const BasicEngine<TNodeID,TLinkID>& engine)
+{
+    // The problem's links, then the engine's added links with the limits of their counters
+    const BasicProblem<TNodeID,TLinkID>& problem = *engine.problem;
+    const TLinkID linkSize = engine.counterVector.size();
+    const TOffset linkNodeSize = problem.linkOffsetArray[4 * problem.linkSize];
+    std::shared_ptr<BasicProblem<TNodeID,TLinkID>> merged(new BasicProblem<TNodeID,TLinkID>());
+    merged->kindVector.reserve(linkSize);
+    merged->kindVector.assign(problem.kindArray, problem.kindArray + problem.linkSize);
+    merged->kindVector.insert(merged->kindVector.end(), engine.addKindVector.cbegin(), engine.addKindVector.cend());
+    merged->limitVector.reserve(linkSize);
+    merged->limitVector.assign(problem.limitArray, problem.limitArray + problem.linkSize);
+    for (TLinkID linkID = problem.linkSize; linkID < linkSize; linkID++)
+        merged->limitVector.push_back({engine.counterVector[linkID].inLimit, engine.counterVector[linkID].outLimit});
+    merged->linkOffsetVector.reserve(4 * linkSize + 1);
+    merged->linkOffsetVector.assign(problem.linkOffsetArray, problem.linkOffsetArray + 4 * problem.linkSize + 1);
+    for (size_t i = 1; i < engine.addLinkOffsetVector.size(); i++)
+        merged->linkOffsetVector.push_back(linkNodeSize + engine.addLinkOffsetVector[i]);
+    merged->linkNodeVector.reserve(linkNodeSize + engine.addLinkNodeVector.size());
+    merged->linkNodeVector.assign(problem.linkNodeArray, problem.linkNodeArray + linkNodeSize);
+    merged->linkNodeVector.insert(merged->linkNodeVector.end(), engine.addLinkNodeVector.cbegin(), engine.addLinkNodeVector.cend());
+    merged->build(problem.nodeSize);
+    return merged;
+}
+
+bool Loader::saveEngine(const string& path, const AnyEngine& engine)
+{
+    return std::visit([&path](const auto& engine) { return saveEngine(path, engine); }, engine);
+}
+
+template<typename TNodeID, typename TLinkID>
+bool Loader::loadEngine(const string& path, BasicEngine<TNodeID,TLinkID>& engine)
+{
+    return loadEngine(std::make_shared<const MappedFile>(path, MADV_WILLNEED), engine);
+}
+
+bool Loader::loadEngine(const string& path, AnyEngine& engine)
+{
+    // The ID widths the file was saved with pick the engine
+    const std::shared_ptr<const MappedFile> file = std::make_shared<const MappedFile>(path, MADV_WILLNEED);
+    if (!file->isOpen() || file->getSize() < sizeof(EngineHeader)) return false;
+    if (reinterpret_cast<const EngineHeader*>(file->begin())->nodeIDSize == sizeof(Engine16::NodeID)) {
+        Engine16 loaded;
+        if (!loadEngine(file, loaded)) return false;
+        engine = std::move(loaded);
+    } else {
+        Engine loaded;
+        if (!loadEngine(file, loaded)) return false;
+        engine = std::move(loaded);
+    }
+    return true;
+}
+
+template<typename TNodeID, typename TLinkID>
+bool Loader::loadEngine(const std::shared_ptr<const MappedFile>& file, BasicEngine<TNodeID,TLinkID>& engine)
+{
+    typedef BasicEngine<TNodeID,TLinkID> TEngine;
+    typedef typename TEngine::Counter Counter;
+    typedef typename TEngine::TOrder TOrder;
+    typedef typename TEngine::Change Change;
+    if (!file->isOpen() || file->getSize() < sizeof(EngineHeader)) return false;
+    EngineHeader header;
+    std::memcpy(&header, file->begin(), sizeof(header));
+    if (std::memcmp(header.magic, ENGINE_MAGIC, sizeof(header.magic)) != 0 ||
+        header.version != ENGINE_VERSION || header.byteOrder != ENGINE_BYTE_ORDER) return false;
+    if (header.nodeIDSize != sizeof(TNodeID) || header.linkIDSize != sizeof(TLinkID) ||
+        header.offsetSize != sizeof(TOffset) || header.reasonIDSize != sizeof(TReasonID)) return false;
+    const unsigned long long nodeSize = header.nodeSize;
+    const unsigned long long linkSize = header.linkSize;
+    if (nodeSize >= TNodeID(~TNodeID(0)) || linkSize > TLinkID(~TLinkID(0)) ||
+        header.nodeLinkSize > TOffset(~TOffset(0)) || header.linkNodeSize > TOffset(~TOffset(0)) ||
+        header.trueSize + header.falseSize > nodeSize || header.changeSize > TOffset(~TOffset(0))) return false;
+
+    // Check the sections fill the file before pointing into it
+    const size_t sectionSizes[] = {
+        (6 * nodeSize + 1) * sizeof(TOffset),
+        header.nodeLinkSize * sizeof(TLinkID),
+        linkSize * sizeof(Kind),
+        linkSize * sizeof(pair<TNodeID,TNodeID>),
+        linkSize * sizeof(unsigned char),
+        (4 * linkSize + 1) * sizeof(TOffset),
+        header.linkNodeSize * sizeof(TNodeID),
+        nodeSize * sizeof(State),
+        linkSize * sizeof(Counter),
+        nodeSize * sizeof(TNodeID),
+        nodeSize * sizeof(TReasonID),
+        nodeSize * sizeof(TNodeID),
+        nodeSize * sizeof(TOrder),
+        header.changeSize * sizeof(Change),
+        nodeSize * sizeof(TOffset)};
+    size_t fileSize = padSize(sizeof(EngineHeader));
+    for (const size_t sectionSize : sectionSizes) fileSize += padSize(sectionSize);
+    if (fileSize != file->getSize()) return false;
+    const char* ptr = file->begin() + padSize(sizeof(EngineHeader));
+    if (hashWords(HASH_BASIS, ptr, file->getSize() - padSize(sizeof(EngineHeader))) != header.checksum) return false;
+    const size_t* sectionSizePtr = sectionSizes;
+    auto section = [&ptr, &sectionSizePtr]() {
+        const char* sectionPtr = ptr;
+        ptr += padSize(*(sectionSizePtr++));
+        return sectionPtr;
+    };
+
+    const TOffset* nodeOffsetArray = reinterpret_cast<const TOffset*>(section());
+    const TLinkID* nodeLinkArray = reinterpret_cast<const TLinkID*>(section());
+    const Kind* kindArray = reinterpret_cast<const Kind*>(section());
+    const pair<TNodeID,TNodeID>* limitArray = reinterpret_cast<const pair<TNodeID,TNodeID>*>(section());
+    const unsigned char* rangeArray = reinterpret_cast<const unsigned char*>(section());
+    const TOffset* linkOffsetArray = reinterpret_cast<const TOffset*>(section());
+    const TNodeID* linkNodeArray = reinterpret_cast<const TNodeID*>(section());
+    const State* stateArray = reinterpret_cast<const State*>(section());
+    const Counter* counterArray = reinterpret_cast<const Counter*>(section());
+    const TNodeID* nodeIDArray = reinterpret_cast<const TNodeID*>(section());
+    const TReasonID* reasonArray = reinterpret_cast<const TReasonID*>(section());
+    const TNodeID* levelArray = reinterpret_cast<const TNodeID*>(section());
+    const TOrder* orderArray = reinterpret_cast<const TOrder*>(section());
+    const Change* changeArray = reinterpret_cast<const Change*>(section());
+    const TOffset* changeMarkArray = reinterpret_cast<const TOffset*>(section());
+
+    // The engine indexes with these unchecked, so a damaged file must stop here
+    auto isOffsets = [](const TOffset* offsetArray, const size_t size, const unsigned long long end) {
+        if (offsetArray[0] != 0 || offsetArray[size - 1] != end) return false;
+        for (size_t i = 1; i < size; i++)
+            if (offsetArray[i] < offsetArray[i - 1]) return false;
+        return true;
+    };
+    if (!isOffsets(nodeOffsetArray, 6 * nodeSize + 1, header.nodeLinkSize) ||
+        !isOffsets(linkOffsetArray, 4 * linkSize + 1, header.linkNodeSize)) return false;
+    for (unsigned long long i = 0; i < header.nodeLinkSize; i++)
+        if (nodeLinkArray[i] >= linkSize) return false;
+    for (unsigned long long i = 0; i < header.linkNodeSize; i++)
+        if (linkNodeArray[i] >= nodeSize) return false;
+    for (unsigned long long linkID = 0; linkID < linkSize; linkID++) {
+        const TOffset* offsetPtr = linkOffsetArray + 4 * linkID;
+        if (kindArray[linkID] > LAZY || rangeArray[linkID] >> 4 ||
+            counterArray[linkID].inLimit != limitArray[linkID].first ||
+            counterArray[linkID].outLimit != limitArray[linkID].second) return false;
+        if (kindArray[linkID] == LAZY) {
+            const TNodeID outLimit = limitArray[linkID].second;
+            if (offsetPtr[0] != offsetPtr[2] || outLimit == 0 || outLimit >= offsetPtr[4] - offsetPtr[2]) return false;
+        }
+        // A run is scanned from its first node by count alone
+        for (TOffset k = 0; k < 4; k++) {
+            if (!(rangeArray[linkID] & (1 << k))) continue;
+            for (TOffset i = offsetPtr[k] + 1; i < offsetPtr[k + 1]; i++)
+                if (linkNodeArray[i] != linkNodeArray[i - 1] + 1) return false;
+        }
+    }
+    // Each assigned node once on its side of the trail, with a reason among the links
+    vector<bool> seenVector(nodeSize, false);
+    unsigned long long assignedSize = 0;
+    for (unsigned long long nodeID = 0; nodeID < nodeSize; nodeID++) {
+        if (stateArray[nodeID] > MAYBE) return false;
+        if (stateArray[nodeID] == MAYBE) continue;
+        assignedSize++;
+        if (reasonArray[nodeID] != TEngine::DECISION && reasonArray[nodeID] >= linkSize) return false;
+    }
+    if (assignedSize != header.trueSize + header.falseSize) return false;
+    for (unsigned long long i = 0; i < nodeSize; i++) {
+        if (i >= header.trueSize && i < nodeSize - header.falseSize) continue;
+        const TNodeID nodeID = nodeIDArray[i];
+        if (nodeID >= nodeSize || seenVector[nodeID] ||
+            stateArray[nodeID] != (i < header.trueSize ? TRUE : FALSE)) return false;
+        seenVector[nodeID] = true;
+    }
+    // The counter trail undoes the base constraints as saved, with no replay
+    for (unsigned long long i = 0; i < header.changeSize; i++)
+        if (changeArray[i].linkID >= linkSize) return false;
+    for (unsigned long long nodeID = 0; nodeID < nodeSize; nodeID++)
+        if (changeMarkArray[nodeID] > header.changeSize) return false;
+
+    // The problem reads the mapping in place and keeps it alive
+    std::shared_ptr<BasicProblem<TNodeID,TLinkID>> problem(new BasicProblem<TNodeID,TLinkID>());
+    problem->nodeSize = nodeSize;
+    problem->linkSize = linkSize;
+    problem->nodeOffsetArray = nodeOffsetArray;
+    problem->nodeLinkArray = nodeLinkArray;
+    problem->kindArray = kindArray;
+    problem->limitArray = limitArray;
+    problem->rangeArray = rangeArray;
+    problem->linkOffsetArray = linkOffsetArray;
+    problem->linkNodeArray = linkNodeArray;
+    problem->storage = file;
+
+    TEngine loaded(std::move(problem));
+    std::copy(stateArray, stateArray + nodeSize, loaded.stateVector.begin());
+    std::copy(counterArray, counterArray + linkSize, loaded.counterVector.begin());
+    std::copy(nodeIDArray, nodeIDArray + nodeSize, loaded.nodeIDArray.get());
+    std::copy(reasonArray, reasonArray + nodeSize, loaded.reasonVector.begin());
+    std::copy(levelArray, levelArray + nodeSize, loaded.levelVector.begin());
+    std::copy(orderArray, orderArray + nodeSize, loaded.orderVector.begin());
+    loaded.trueNodeIDPtrTop = loaded.nodeIDArray.get() + header.trueSize;
+    loaded.falseNodeIDPtrTop = loaded.nodeIDArray.get() + nodeSize - 1 - header.falseSize;
+    loaded.order = header.order;
+    loaded.changeVector.assign(changeArray, changeArray + header.changeSize);
+    std::copy(changeMarkArray, changeMarkArray + nodeSize, loaded.changeMarkVector.begin());
+    loaded.constrain_watch();
+    engine = std::move(loaded);
+    return true;
+}
+
+template bool Loader::saveEngine(const string& path, const Engine& engine);
+template bool Loader::saveEngine(const string& path, const Engine16& engine);
+template bool Loader::loadEngine(const string& path, Engine& engine);
+template bool Loader::loadEngine(const string& path, Engine16& engine);
\ No newline at end of file
@@ -0,0 +1,62 @@
+#pragma once
+#include <string>
+#include <memory>
+#include "imply.h"
+
+namespace Imply
+{
+    // Reads DIMACS CNF and OPB files into a Problem: the file is memory-mapped and
+    // parsed in one pass straight into the problem's link rows, with no Link per
+    // constraint. A clause becomes Link({}, {}, GE, 0, positives, negatives, GE, 1);
+    // an OPB constraint with coefficients of +1 and -1 becomes the same link with its
+    // own Equality and limit, an equality two links. Variable k is node k - 1.
+    // Both return false for a file that cannot be read, parsed or represented.
+    //
+    // Also saves and loads compiled engines: a versioned binary image of an engine's
+    // problem arrays, states, counters, trail and counter trail as they are laid out
+    // in memory, so a model built and constrained once starts solving in any process.
+    // Loading maps the file and points the problem straight into the mapping, with
+    // nothing to parse, build or replay; only the engine's own states are copied out. Links added to the engine
+    // are saved as links of the problem. Heuristic and learning settings are not
+    // saved, nor is an engine whose search is suspended, see BasicEngine::solve. A
+    // file only loads into IDs of the widths it was saved with, on a machine of the
+    // same byte order. Loading checks a checksum of the sections and that every ID and
+    // offset lies inside its array, and returns false for a damaged file.
+    class Loader
+    {
+    private:
+        const char* ptr;
+        const char* endPtr;
+        std::shared_ptr<Problem> problem;
+        TNodeID nodeSize;
+        bool contradiction;
+        // Nodes of the constraint being read, by literal sign; reused across constraints
+        vector<TNodeID> trueNodeIDs;
+        vector<TNodeID> falseNodeIDs;
+    public:
+        static bool loadCNF(const std::string& path, std::shared_ptr<const Problem>& problem);
+        static bool loadOPB(const std::string& path, std::shared_ptr<const Problem>& problem);
+        template<typename TNodeID, typename TLinkID>
+        static bool saveEngine(const std::string& path, const BasicEngine<TNodeID,TLinkID>& engine);
+        static bool saveEngine(const std::string& path, const AnyEngine& engine);
+        template<typename TNodeID, typename TLinkID>
+        static bool loadEngine(const std::string& path, BasicEngine<TNodeID,TLinkID>& engine);
+        static bool loadEngine(const std::string& path, AnyEngine& engine);
+    private:
+        class MappedFile;
+        Loader(const char* ptr, const char* endPtr);
+        bool readCNF();
+        bool readOPB();
+        void skipSpace() noexcept;
+        void skipLine() noexcept;
+        bool readInteger(long long& value) noexcept;
+        bool readWord(const char* word) noexcept;
+        bool addLink(Equality equality, long long limit);
+        bool addLink(const vector<TNodeID>& trueOutNodeIDs, const vector<TNodeID>& falseOutNodeIDs, TNodeID outLimit);
+        std::shared_ptr<const Problem> finish();
+        template<typename TNodeID, typename TLinkID>
+        static bool loadEngine(const std::shared_ptr<const MappedFile>& file, BasicEngine<TNodeID,TLinkID>& engine);
+        template<typename TNodeID, typename TLinkID>
+        static std::shared_ptr<const BasicProblem<TNodeID,TLinkID>> mergeLinks(const BasicEngine<TNodeID,TLinkID>& engine);
+    };
+};
\ No newline at end of file
@@ -2,6 +2,9 @@
 #include <tuple>
 #include <cmath>
 #include <cassert>
+#include <algorithm>
+#include <type_traits>
+#include <chrono>
 #include "sudoku.h"
 using std::vector;
 using std::tuple;
@@ -10,22 +13,40 @@ using namespace Imply;
 using namespace Sudoku;
 
 Solver::Solver(TSize size)
-    : size(size)
+    : size(size), probing(false), probeSeconds(0), searchSeconds(0)
 {
     const TSize2 size2 = size * size;
+    engine = makeEngine(EXACTLY_ONE, getGroups(), size2, index(size2 - 1, size2 - 1, size2 - 1) + 1);
+}
+
+Solver::Solver(TSize size, AnyEngine&& engine)
+    : size(size), engine(std::move(engine)), probing(false), probeSeconds(0), searchSeconds(0) {}
+
+vector<Link> Solver::getLinks() const
+{
+    const TSize2 size2 = size * size;
+    const vector<TNodeID> groups = getGroups();
 
     vector<Link> links;
-    links.reserve(2 * 4 * size2 * size2);
-    vector<TNodeID> group(size2, 0);
+    links.reserve(groups.size() / size2);
+    for (auto iter = groups.cbegin(); iter != groups.cend(); iter += size2)
+        links.push_back(Link(EXACTLY_ONE, vector<TNodeID>(iter, iter + size2)));
+    return links;
+}
+
+vector<TNodeID> Solver::getGroups() const
+{
+    const TSize2 size2 = size * size;
+
+    vector<TNodeID> groups;
+    groups.reserve((TSize8) 4 * size2 * size2 * size2);
 
     // Cell
     for (TSize2 row = 0; row < size2; row++) {
         for (TSize2 col = 0; col < size2; col++) {
             for (TSize2 num = 0; num < size2; num++) {
-                group[num] = index(row, col, num);
+                groups.push_back(index(row, col, num));
             }
-            links.push_back(Link({}, {}, GE, 0, group, {}, LE, 1));
-            links.push_back(Link({}, {}, GE, 0, group, {}, GE, 1));
         }
     }
     // Box
@@ -34,14 +55,12 @@ Solver::Solver(TSize size)
             for (TSize2 num = 0; num < size2; num++) {
                 for (TSize brow2 = 0; brow2 < size; brow2++) {
                     for (TSize bcol2 = 0; bcol2 < size; bcol2++) {
-                        group[brow2 * size + bcol2] = index(
+                        groups.push_back(index(
                             brow * size + brow2, 
                             bcol * size + bcol2,
-                            num);
+                            num));
                     }
                 }
-                links.push_back(Link({}, {}, GE, 0, group, {}, LE, 1));
-                links.push_back(Link({}, {}, GE, 0, group, {}, GE, 1));
             }
         }
     }
@@ -49,35 +68,185 @@ Solver::Solver(TSize size)
     for (TSize2 row = 0; row < size2; row++) {
         for (TSize2 num = 0; num < size2; num++) {
             for (TSize2 col = 0; col < size2; col++) {
-                group[col] = index(row, col, num);
+                groups.push_back(index(row, col, num));
             }
-            links.push_back(Link({}, {}, GE, 0, group, {}, LE, 1));
-            links.push_back(Link({}, {}, GE, 0, group, {}, GE, 1));
         }
     }
     // Col
     for (TSize2 col = 0; col < size2; col++) {
         for (TSize2 num = 0; num < size2; num++) {
             for (TSize2 row = 0; row < size2; row++) {
-                group[row] = index(row, col, num);
+                groups.push_back(index(row, col, num));
             }
-            links.push_back(Link({}, {}, GE, 0, group, {}, LE, 1));
-            links.push_back(Link({}, {}, GE, 0, group, {}, GE, 1));
         }
     }
-    
-    engine = Engine(std::move(links), index(size2, size2, size2) + 1);
+    return groups;
+}
+
+void Solver::setHeuristic(Heuristic heuristic, bool phaseSaving)
+{
+    std::visit([&](auto& engine) { engine.setHeuristic(heuristic, phaseSaving); }, engine);
+}
+
+void Solver::setLearning(bool learning)
+{
+    std::visit([&](auto& engine) { engine.setLearning(learning); }, engine);
+}
+
+void Solver::setRestarts(Restart restart, TCount unit)
+{
+    std::visit([&](auto& engine) { engine.setRestarts(restart, unit); }, engine);
+}
+
+void Solver::setProbing(bool probing, double seconds)
+{
+    Solver::probing = probing;
+    probeSeconds = seconds;
+}
+
+void Solver::setTimeout(double seconds)
+{
+    searchSeconds = seconds;
+}
+
+template<typename TEngine>
+static bool search(TEngine& engine, const unsigned int threadCount, const double seconds)
+{
+    // A search out of time stays suspended until the next constrain or reset drops it
+    if (seconds <= 0) return engine.backtrack(threadCount);
+    typedef std::chrono::steady_clock Clock;
+    Limits limits;
+    limits.deadline = Clock::now() + std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(seconds));
+    return engine.solve(limits, threadCount) == SAT;
+}
+
+bool Solver::solve(vector<tuple<TSize2,TSize2,TSize2>> rcnums, bool backtrack, unsigned int threadCount)
+{
+    return std::visit([&](auto& engine) {
+        vector<typename std::decay_t<decltype(engine)>::NodeID> trueNodeIDs;
+        trueNodeIDs.reserve(rcnums.size());
+        for (auto [row, col, num] : rcnums)
+            trueNodeIDs.push_back(index(row, col, num - 1));
+        return (
+            engine.constrain(trueNodeIDs, {}) && 
+            (backtrack ? 
+                (!probing || engine.probe(threadCount, probeSeconds)) && search(engine, threadCount, searchSeconds) : 
+                true));
+    }, engine);
+}
+
+TCount Solver::count(vector<tuple<TSize2,TSize2,TSize2>> rcnums, TCount limit)
+{
+    // limit = 2 is enough to tell a unique puzzle apart
+    return std::visit([&](auto& engine) {
+        vector<typename std::decay_t<decltype(engine)>::NodeID> trueNodeIDs;
+        trueNodeIDs.reserve(rcnums.size());
+        for (auto [row, col, num] : rcnums)
+            trueNodeIDs.push_back(index(row, col, num - 1));
+        if (!engine.constrain(trueNodeIDs, {})) return TCount(0);
+        return !probing || engine.probe(1, probeSeconds) ? engine.count(limit) : TCount(0);
+    }, engine);
 }
 
-bool Solver::solve(vector<tuple<TSize2,TSize2,TSize2>> rcnums, bool backtrack)
+void Solver::reset() noexcept
 {
-    vector<TNodeID> trueNodeIDs;
-    trueNodeIDs.reserve(rcnums.size());
+    // Back to the empty grid, keeping the links
+    std::visit([](auto& engine) { engine.reset(); }, engine);
+}
+
+const Statistics& Solver::getStatistics() const noexcept
+{
+    return std::visit([](const auto& engine) -> const Statistics& { return engine.getStatistics(); }, engine);
+}
+
+// Line format: one cell per character, row by row; '.' or '0' is empty
+static const char SYMBOLS[] = "123456789ABCDEFGHIJKLMNOPQRSTUVWXYZ";
+
+bool Solver::parse(const string& line, vector<tuple<TSize2,TSize2,TSize2>>& rcnums) const
+{
+    const TSize2 size2 = size * size;
+    assert(size2 < sizeof(SYMBOLS));
+    rcnums.clear();
+    if (line.size() != (TSize8) size2 * size2) return false;
+    for (TSize4 i = 0; i < line.size(); i++) {
+        const char symbol = line[i];
+        if (symbol == '.' || symbol == '0') continue;
+        const char* symbolPtr = std::find(SYMBOLS, SYMBOLS + size2, symbol);
+        if (symbolPtr == SYMBOLS + size2) return false;
+        rcnums.push_back({i / size2, i % size2, symbolPtr - SYMBOLS + 1});
+    }
+    return true;
+}
+
+string Solver::format() const
+{
+    const TSize2 size2 = size * size;
+    assert(size2 < sizeof(SYMBOLS));
+    string line(size2 * size2, '.');
+    for (TSize2 row = 0; row < size2; row++) {
+        for (TSize2 col = 0; col < size2; col++) {
+            const TSize2 num = get(row, col);
+            if (num != 0) line[row * size2 + col] = SYMBOLS[num - 1];
+        }
+    }
+    return line;
+}
+
+string Solver::format(const vector<tuple<TSize2,TSize2,TSize2>>& rcnums) const
+{
+    const TSize2 size2 = size * size;
+    assert(size2 < sizeof(SYMBOLS));
+    string line(size2 * size2, '.');
     for (auto [row, col, num] : rcnums)
-        trueNodeIDs.push_back(index(row, col, num - 1));
-    return (
-        engine.constrain(trueNodeIDs, {}) && 
-        (backtrack ? engine.backtrack() : true));
+        line[row * size2 + col] = SYMBOLS[num - 1];
+    return line;
+}
+
+TSize4 Solver::solveLanes(const vector<vector<tuple<TSize2,TSize2,TSize2>>>& rcnumsVector, vector<string>& lines)
+{
+    const TSize2 size2 = size * size;
+    assert(rcnumsVector.size() <= Lanes::LANE_COUNT);
+    if (!lanes) lanes = makeLanes(engine);
+    lines.assign(rcnumsVector.size(), string());
+    TSize4 solvedCount = 0;
+    std::visit([&](auto& lanes, auto& engine) {
+        typedef std::decay_t<decltype(lanes)> TLanes;
+        typedef typename TLanes::NodeID TNodeID;
+        if constexpr (std::is_same_v<TNodeID, typename std::decay_t<decltype(engine)>::NodeID>) {
+            lanes.reset();
+            for (TSize4 lane = 0; lane < rcnumsVector.size(); lane++)
+                for (auto [row, col, num] : rcnumsVector[lane])
+                    lanes.assign(lane, index(row, col, num - 1), true);
+            const typename TLanes::TLanes conflictLanes = lanes.constrain();
+            const typename TLanes::TLanes solvedLanes = lanes.isComplete() ? lanes.getAssignedLanes() & ~conflictLanes : 0;
+            // Solved by propagation alone, written out a node at a time for all lanes
+            for (TSize4 lane = 0; lane < rcnumsVector.size(); lane++)
+                if (solvedLanes >> lane & 1) lines[lane].assign(size2 * size2, '.');
+            for (TSize2 row = 0; row < size2; row++) {
+                for (TSize2 col = 0; col < size2; col++) {
+                    for (TSize2 num = 0; num < size2; num++) {
+                        typename TLanes::TLanes trueLanes = lanes.getTrueLanes(index(row, col, num)) & solvedLanes;
+                        for ( ; trueLanes != 0; trueLanes &= trueLanes - 1)
+                            lines[__builtin_ctzll(trueLanes)][row * size2 + col] = SYMBOLS[num];
+                    }
+                }
+            }
+            solvedCount += __builtin_popcountll(solvedLanes);
+            // Or else searched from where propagation stopped
+            vector<pair<TNodeID,bool>> nodeStates;
+            for (TSize4 lane = 0; lane < rcnumsVector.size(); lane++) {
+                if ((conflictLanes | solvedLanes) >> lane & 1) continue;
+                lanes.getNodeStates(lane, nodeStates);
+                if (engine.constrain(nodeStates) && 
+                    (!probing || engine.probe(1, probeSeconds)) && search(engine, 1, searchSeconds)) {
+                    lines[lane] = format();
+                    solvedCount++;
+                }
+                engine.reset();
+            }
+        }
+    }, *lanes, engine);
+    return solvedCount;
 }
 
 void Solver::print(const vector<tuple<TSize2,TSize2,TSize2>>& rcnums) const
@@ -104,19 +273,21 @@ void Solver::print() const
     print(nums);
 }
 
-TSize8 Solver::index(TSize2 row, TSize2 col, TSize2 num) const noexcept
+TSize4 Solver::index(TSize2 row, TSize2 col, TSize2 num) const noexcept
 {
-    const TSize2 size2 = size * size;
-    return row * size2 * size2 + col * size2 + num;
+    const TSize4 size2 = size * size;
+    return (row * size2 + col) * size2 + num;
 }
 
 TSize2 Solver::get(TSize2 row, TSize2 col) const noexcept
 {
-    for (TSize2 num = 0; num < size * size; num++) {
-        if (engine.getNodeState(index(row, col, num)) == TRUE)
-            return num + 1;
-    }
-    return 0;
+    return std::visit([&](const auto& engine) -> TSize2 {
+        for (TSize2 num = 0; num < size * size; num++) {
+            if (engine.getNodeState(index(row, col, num)) == TRUE)
+                return num + 1;
+        }
+        return 0;
+    }, engine);
 }
 
 void Solver::printDivider() const noexcept
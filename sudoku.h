@@ -1,5 +1,8 @@
+#pragma once
 #include <vector>
 #include <tuple>
+#include <string>
+#include <optional>
 #include "imply.h"
 using namespace Imply;
 
@@ -7,6 +10,7 @@ namespace Sudoku
 {
     using std::vector;
     using std::tuple;
+    using std::string;
     typedef unsigned char TSize;
     typedef unsigned short TSize2;
     typedef unsigned int TSize4;
@@ -14,8 +18,16 @@ namespace Sudoku
     class Solver
     {
     private:
+        friend class Generator;
         const TSize size;
-        Engine engine;
+        AnyEngine engine;
+        // Probing before each search, see Engine::probe; no budget when zero seconds
+        bool probing;
+        double probeSeconds;
+        // Time budget of each search, see Engine::solve; none when zero
+        double searchSeconds;
+        // Lanes of solveLanes, made on first use
+        std::optional<AnyLanes> lanes;
     public:
         Solver(const Solver& other) = default;
         Solver& operator=(const Solver& other) = default;
@@ -23,11 +35,39 @@ namespace Sudoku
         Solver& operator=(Solver&& other) = default;
 
         Solver(TSize size);
-        bool solve(vector<tuple<TSize2,TSize2,TSize2>> rcnums, bool backtrack = false);
+        // Takes an engine over getLinks(), e.g. one loaded from a compiled engine file
+        Solver(TSize size, AnyEngine&& engine);
+        // Exactly-one links of the board over the nodes (row * size^2 + col) * size^2 + num - 1
+        vector<Link> getLinks() const;
+        // The same groups, size^2 nodes each back to back, as the solver builds its
+        // problem from them. With n = size^2 nodes per cell the problem takes 48n + 88
+        // bytes per cell up to 25x25, in 16-bit IDs, and 72n + 104 beyond; each engine,
+        // and each extra search thread, 45n + 64 or 49n + 96 more, without learning.
+        vector<TNodeID> getGroups() const;
+        void setHeuristic(Heuristic heuristic, bool phaseSaving = false);
+        void setLearning(bool learning);
+        void setRestarts(Restart restart, TCount unit = 100);
+        void setProbing(bool probing, double seconds = 0);
+        // A search out of time fails as if the puzzle had no solution
+        void setTimeout(double seconds);
+        bool solve(vector<tuple<TSize2,TSize2,TSize2>> rcnums, bool backtrack = false, unsigned int threadCount = 1);
+        TCount count(vector<tuple<TSize2,TSize2,TSize2>> rcnums, TCount limit = 0);
+        // Solves up to Lanes::LANE_COUNT puzzles together: propagation runs over all of
+        // them at once, see BasicLanes, and only the puzzles it leaves open are searched,
+        // one by one, on this solver's engine. Each line becomes its puzzle's solution in
+        // the format of format(), or empty if there is none; returns how many are solved.
+        TSize4 solveLanes(const vector<vector<tuple<TSize2,TSize2,TSize2>>>& rcnumsVector, vector<string>& lines);
+        void reset() noexcept;
+        const Statistics& getStatistics() const noexcept;
+        const AnyEngine& getEngine() const noexcept { return engine; }
+        bool parse(const string& line, vector<tuple<TSize2,TSize2,TSize2>>& rcnums) const;
+        string format() const;
+        // Just the givens, in the same format
+        string format(const vector<tuple<TSize2,TSize2,TSize2>>& rcnums) const;
         void print(const vector<tuple<TSize2,TSize2,TSize2>>& number) const;
         void print() const;
     private:
-        TSize8 index(TSize2 row, TSize2 col, TSize2 num) const noexcept;
+        TSize4 index(TSize2 row, TSize2 col, TSize2 num) const noexcept;
         TSize2 get(TSize2 row, TSize2 col) const noexcept;
         void printDivider() const noexcept;
         void print(const vector<TSize2>& nums) const noexcept;
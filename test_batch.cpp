@@ -0,0 +1,83 @@
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <cstdlib>
+#include "batch.h"
+using std::string;
+
+// Known puzzles, each line with its expected output line: two that need search
+// after propagation, an easy one, then a contradiction, an empty line and a
+// malformed one, all written as empty lines
+static const char* CASES[][2] = {
+    {"8..........36......7..9.2...5...7.......457.....1...3...1....68..85...1..9....4..",
+     "812753649943682175675491283154237896369845721287169534521974368438526917796318452"},
+    {"1....7.9..3..2...8..96..5....53..9...1..8...26....4...3......1..4......7..7...3..",
+     "162857493534129678789643521475312986913586742628794135356478219241935867897261354"},
+    {"53..7....6..195....98....6.8...6...34..8.3..17...2...6.6....28....419..5....8..79",
+     "534678912672195348198342567859761423426853791713924856961537284287419635345286179"},
+    {"11...............................................................................", ""},
+    {"", ""},
+    {"12x", ""}};
+
+// Runs the cases through batches of every shape, small chunks so lines cross
+// chunks and threads, and checks each output line against its case in order
+static int check()
+{
+    std::ostringstream input, expected;
+    for (unsigned int i = 0; i < 4; i++)
+        for (const auto& [puzzle, solution] : CASES) {
+            input << puzzle << "\n";
+            expected << solution << "\n";
+        }
+    unsigned int failCount = 0;
+    for (const unsigned int threadCount : {1, 3}) {
+        for (const bool lanes : {false, true}) {
+            std::istringstream inputStream(input.str());
+            std::ostringstream output;
+            const Sudoku::Report report = Sudoku::Batch(3, threadCount, false, lanes, 5).run(inputStream, output);
+            if (output.str() != expected.str() || report.solvedCount != 12) {
+                std::cerr << "FAIL threads " << threadCount << " lanes " << lanes << "\n";
+                failCount++;
+            }
+        }
+    }
+    std::cout << failCount << " failures\n";
+    return failCount == 0 ? 0 : 1;
+}
+
+// Usage: test_batch [size] [threads] [input] [output] [learning] [lanes] [timeout]
+//   Solves one puzzle per line (81 characters for size 3, '.' or '0' empty),
+//   writing its solution or an empty line if there is none; '-' or no file
+//   means stdin/stdout. The report goes to stderr. Lanes
+//   are on unless 0; a timeout in seconds bounds each puzzle's search.
+//   test_batch check runs known puzzles instead and exits 1 on a wrong line.
+int main(int argc, char** argv)
+{
+    if (argc > 1 && string(argv[1]) == "check") return check();
+    const Sudoku::TSize size = argc > 1 ? std::atoi(argv[1]) : 3;
+    const unsigned int threadCount = argc > 2 ? std::atoi(argv[2]) : std::thread::hardware_concurrency();
+    const string inputPath = argc > 3 ? argv[3] : "-";
+    const string outputPath = argc > 4 ? argv[4] : "-";
+    const bool learning = argc > 5 && std::atoi(argv[5]) != 0;
+    const bool lanes = argc <= 6 || std::atoi(argv[6]) != 0;
+    const double timeout = argc > 7 ? std::atof(argv[7]) : 0;
+
+    std::ifstream inputFile;
+    std::ofstream outputFile;
+    if (inputPath != "-") inputFile.open(inputPath);
+    if (outputPath != "-") outputFile.open(outputPath);
+    std::istream& input = inputPath != "-" ? inputFile : std::cin;
+    std::ostream& output = outputPath != "-" ? outputFile : std::cout;
+    if (!input || !output) {
+        std::cerr << "Cannot open " << (!input ? inputPath : outputPath) << "\n";
+        return 1;
+    }
+    std::ios::sync_with_stdio(false);
+
+    Sudoku::Batch batch(size, threadCount, learning, lanes, 256, timeout);
+    Sudoku::Report report = batch.run(input, output);
+    report.print(std::cerr);
+    return 0;
+}
\ No newline at end of file
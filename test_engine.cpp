@@ -0,0 +1,318 @@
+#include <iostream>
+#include <vector>
+#include <random>
+#include <algorithm>
+#include <cstdlib>
+#include <variant>
+#include "imply.h"
+using namespace std;
+using namespace Imply;
+
+// A link as given, for checking assignments by hand
+struct Spec
+{
+    vector<unsigned int> trueIn, falseIn;
+    Equality inEquality;
+    unsigned int inLimit;
+    vector<unsigned int> trueOut, falseOut;
+    Equality outEquality;
+    unsigned int outLimit;
+    Kind kind = GENERIC;
+};
+
+static bool compare(unsigned int count, Equality equality, unsigned int limit)
+{
+    if (equality == GE) return count >= limit;
+    if (equality == GT) return count > limit;
+    if (equality == LE) return count <= limit;
+    return count < limit;
+}
+
+static bool holds(const Spec& spec, const vector<bool>& values)
+{
+    auto countOf = [&values](const vector<unsigned int>& trues, const vector<unsigned int>& falses) {
+        unsigned int count = 0;
+        for (unsigned int nodeID : trues) count += values[nodeID];
+        for (unsigned int nodeID : falses) count += !values[nodeID];
+        return count;
+    };
+    const unsigned int outCount = countOf(spec.trueOut, spec.falseOut);
+    if (spec.kind == AT_MOST_ONE) return outCount <= 1;
+    if (spec.kind == EXACTLY_ONE) return outCount == 1;
+    return !compare(countOf(spec.trueIn, spec.falseIn), spec.inEquality, spec.inLimit) ||
+        compare(outCount, spec.outEquality, spec.outLimit);
+}
+
+template<typename TNodeID>
+static BasicLink<TNodeID> makeLink(const Spec& spec)
+{
+    auto ids = [](const vector<unsigned int>& nodes) { return vector<TNodeID>(nodes.cbegin(), nodes.cend()); };
+    if (spec.kind != GENERIC) return BasicLink<TNodeID>(spec.kind, ids(spec.trueOut));
+    return BasicLink<TNodeID>(
+        ids(spec.trueIn), ids(spec.falseIn), spec.inEquality, spec.inLimit,
+        ids(spec.trueOut), ids(spec.falseOut), spec.outEquality, spec.outLimit);
+}
+
+// Solutions of the specs under the fixed nodes, by trying every assignment
+static TCount bruteCount(const vector<Spec>& specs, unsigned int nodeSize, const vector<pair<unsigned int,bool>>& fixed)
+{
+    TCount count = 0;
+    vector<bool> values(nodeSize);
+    for (unsigned long long bits = 0; bits < 1ull << nodeSize; bits++) {
+        for (unsigned int nodeID = 0; nodeID < nodeSize; nodeID++) values[nodeID] = bits >> nodeID & 1;
+        bool ok = true;
+        for (const auto& [nodeID, value] : fixed) ok = ok && values[nodeID] == value;
+        for (const Spec& spec : specs) ok = ok && holds(spec, values);
+        count += ok;
+    }
+    return count;
+}
+
+static vector<unsigned int> pick(mt19937& rng, unsigned int nodeSize, unsigned int size)
+{
+    vector<unsigned int> nodes(nodeSize);
+    for (unsigned int nodeID = 0; nodeID < nodeSize; nodeID++) nodes[nodeID] = nodeID;
+    shuffle(nodes.begin(), nodes.end(), rng);
+    nodes.resize(size);
+    return nodes;
+}
+
+static Spec randomSpec(mt19937& rng, unsigned int nodeSize)
+{
+    static const Equality equalities[] = {GE, GT, LE, LT};
+    const unsigned int kind = rng() % 6;
+    if (kind == 0 || kind == 1) {
+        // Group
+        Spec spec {{}, {}, GE, 0, pick(rng, nodeSize, 2 + rng() % 4), {}, GE, 0, kind == 0 ? AT_MOST_ONE : EXACTLY_ONE};
+        return spec;
+    }
+    vector<unsigned int> nodes = pick(rng, nodeSize, 3 + rng() % 3);
+    Spec spec {{}, {}, GE, 0, {}, {}, GE, 1};
+    if (kind == 2) {
+        // Clause
+        for (unsigned int nodeID : nodes) (rng() & 1 ? spec.trueOut : spec.falseOut).push_back(nodeID);
+        return spec;
+    }
+    // Conditional cardinality
+    const unsigned int inSize = 1 + rng() % 2;
+    for (unsigned int i = 0; i < nodes.size(); i++)
+        (i < inSize ? (rng() & 1 ? spec.trueIn : spec.falseIn) : (rng() & 1 ? spec.trueOut : spec.falseOut)).push_back(nodes[i]);
+    spec.inEquality = equalities[rng() % 4];
+    spec.inLimit = rng() % (inSize + 1);
+    // An out side no count can meet, as LT 0, is outside what a link can say
+    const unsigned int outSize = nodes.size() - inSize;
+    spec.outEquality = equalities[rng() % 4];
+    spec.outLimit = rng() % outSize + (spec.outEquality == LT);
+    return spec;
+}
+
+static unsigned int failCount = 0;
+
+static void check(bool ok, const char* what, unsigned int instance)
+{
+    if (ok) return;
+    failCount++;
+    if (failCount <= 20) cout << "FAIL " << what << " on instance " << instance << "\n";
+}
+
+// Random settings, as each check would be run by a user
+template<typename TEngine>
+static void configure(TEngine& engine, mt19937& rng)
+{
+    const Heuristic heuristic = rng() % 3;
+    engine.setHeuristic(heuristic, heuristic != ORDER && rng() % 2);
+    engine.setLearning(rng() % 2, 4 + rng() % 16);
+    engine.setRestarts(rng() % 3, 1 + rng() % 4);
+}
+
+template<typename TEngine>
+static bool isModel(const TEngine& engine, const vector<Spec>& specs, const vector<pair<unsigned int,bool>>& fixed)
+{
+    vector<bool> values(engine.getNodeSize());
+    for (unsigned int nodeID = 0; nodeID < values.size(); nodeID++) {
+        if (engine.getNodeState(nodeID) == MAYBE) return false;
+        values[nodeID] = engine.getNodeState(nodeID) == TRUE;
+    }
+    for (const auto& [nodeID, value] : fixed)
+        if (values[nodeID] != value) return false;
+    for (const Spec& spec : specs)
+        if (!holds(spec, values)) return false;
+    return true;
+}
+
+// count, backtrack with threads, solve with limits and resume, solveUnder, probe,
+// checkpoints and addLink, each against the brute-force count
+template<typename TEngine>
+static void testInstance(mt19937& rng, unsigned int instance)
+{
+    typedef typename TEngine::NodeID TNodeID;
+    const unsigned int nodeSize = 6 + rng() % 9;
+    vector<Spec> specs(nodeSize / 2 + rng() % (2 * nodeSize));
+    for (Spec& spec : specs) spec = randomSpec(rng, nodeSize);
+    vector<BasicLink<TNodeID>> links;
+    for (const Spec& spec : specs) links.push_back(makeLink<TNodeID>(spec));
+    const TCount expected = bruteCount(specs, nodeSize, {});
+
+    {
+        TEngine engine(links, nodeSize);
+        configure(engine, rng);
+        check(engine.count() == expected, "count", instance);
+        check(engine.count(1) == min<TCount>(expected, 1), "count limit", instance);
+        const unsigned int threadCount = 1 + rng() % 4;
+        const bool ret = threadCount == 1 ? engine.backtrack() : engine.backtrack(threadCount);
+        check(ret == (expected > 0) && (!ret || isModel(engine, specs, {})), "backtrack", instance);
+    }
+    {
+        TEngine engine(links, nodeSize);
+        configure(engine, rng);
+        Limits limits;
+        limits.decisionBudget = 1 + rng() % 3;
+        limits.conflictBudget = 1 + rng() % 3;
+        Result result;
+        unsigned int callCount = 0;
+        while ((result = engine.solve(limits, 1 + rng() % 3)) == UNKNOWN && ++callCount < 100000) {}
+        check(result == (expected > 0 ? SAT : UNSAT) && (result != SAT || isModel(engine, specs, {})), "solve", instance);
+    }
+    {
+        TEngine engine(links, nodeSize);
+        configure(engine, rng);
+        for (unsigned int round = 0; round < 4; round++) {
+            vector<pair<TNodeID,bool>> assumptions, core;
+            vector<pair<unsigned int,bool>> fixed;
+            for (unsigned int nodeID : pick(rng, nodeSize, rng() % 4)) {
+                assumptions.push_back({nodeID, rng() % 2 == 0});
+                fixed.push_back({nodeID, assumptions.back().second});
+            }
+            vector<State> model;
+            const bool ret = engine.solveUnder(assumptions, core, model);
+            const bool sat = bruteCount(specs, nodeSize, fixed) > 0;
+            bool ok = ret == sat;
+            if (ok && !ret) {
+                vector<pair<unsigned int,bool>> coreFixed;
+                for (const auto& [nodeID, value] : core) {
+                    ok = ok && find(assumptions.cbegin(), assumptions.cend(), pair<TNodeID,bool>(nodeID, value)) != assumptions.cend();
+                    coreFixed.push_back({nodeID, value});
+                }
+                ok = ok && bruteCount(specs, nodeSize, coreFixed) == 0;
+            }
+            check(ok, "solveUnder", instance);
+        }
+    }
+    {
+        TEngine engine(links, nodeSize);
+        const bool ret = engine.probe(1 + rng() % 3);
+        check(ret ? engine.count() == expected : expected == 0, "probe", instance);
+    }
+    {
+        // Constrain a node at a time, then roll back to each checkpoint in turn
+        TEngine engine(links, nodeSize);
+        configure(engine, rng);
+        vector<typename TEngine::Checkpoint> checkpoints {engine.checkpoint()};
+        vector<vector<pair<unsigned int,bool>>> fixedVector {{}};
+        for (unsigned int nodeID : pick(rng, nodeSize, 1 + rng() % 4)) {
+            if (engine.getNodeState(nodeID) != MAYBE) continue;
+            const bool value = rng() % 2;
+            if (!engine.constrain({{TNodeID(nodeID), value}})) continue;
+            checkpoints.push_back(engine.checkpoint());
+            fixedVector.push_back(fixedVector.back());
+            fixedVector.back().push_back({nodeID, value});
+            if (rng() % 2) engine.backtrack();
+        }
+        for (unsigned int k = checkpoints.size(); k-- > 0; ) {
+            engine.rollback(checkpoints[k]);
+            check(engine.count() == bruteCount(specs, nodeSize, fixedVector[k]), "rollback", instance);
+        }
+    }
+    {
+        // Half the links up front, the rest added one at a time as nodes are fixed
+        const unsigned int baseSize = specs.size() / 2;
+        TEngine engine(vector<BasicLink<TNodeID>>(links.cbegin(), links.cbegin() + baseSize), nodeSize);
+        configure(engine, rng);
+        vector<Spec> added(specs.cbegin(), specs.cbegin() + baseSize);
+        vector<pair<unsigned int,bool>> fixed;
+        for (unsigned int i = baseSize; i < specs.size(); i++) {
+            const unsigned int nodeID = rng() % nodeSize;
+            if (rng() % 3 == 0 && engine.getNodeState(nodeID) == MAYBE && engine.constrain({{TNodeID(nodeID), true}}))
+                fixed.push_back({nodeID, true});
+            added.push_back(specs[i]);
+            if (engine.addLink(links[i])) {
+                if (rng() % 2) engine.count();
+                continue;
+            }
+            check(bruteCount(added, nodeSize, fixed) == 0, "addLink conflict", instance);
+            added.pop_back();
+        }
+        check(engine.count() == bruteCount(added, nodeSize, fixed), "addLink", instance);
+    }
+}
+
+// A large link needing few of its nodes is propagated lazily; the same link
+// behind a condition that always holds is counted as usual, so both must agree
+static void testLazy(mt19937& rng, unsigned int instance)
+{
+    const unsigned int nodeSize = 40;
+    const unsigned int lazySize = 36;
+    const unsigned int atLeast = 1 + rng() % 8;
+    vector<Link> lazyLinks, countedLinks;
+    const vector<unsigned int> nodes = pick(rng, nodeSize, lazySize);
+    lazyLinks.push_back(Link({}, {}, GE, 0, nodes, {}, GE, atLeast));
+    countedLinks.push_back(Link({nodes[0]}, {}, GE, 0, nodes, {}, GE, atLeast));
+    for (unsigned int i = 0; i < 60; i++) {
+        const Spec spec = randomSpec(rng, nodeSize);
+        lazyLinks.push_back(makeLink<unsigned int>(spec));
+        countedLinks.push_back(makeLink<unsigned int>(spec));
+    }
+    Engine lazy(lazyLinks, nodeSize), counted(countedLinks, nodeSize);
+    configure(lazy, rng);
+    const TCount limit = 5000;
+    check(lazy.count(limit) == counted.count(limit), "lazy count", instance);
+    check(Engine(lazy).backtrack(1 + rng() % 3) == Engine(counted).backtrack(), "lazy backtrack", instance);
+}
+
+// Limits past the compact width keep the wide engine, so every limit keeps its meaning
+static void testWideLimits()
+{
+    const vector<Link> links = {
+        Link({}, {}, GE, 0, {0, 1, 2}, {}, LE, 65535),
+        Link({}, {}, GE, 0, {0, 1, 2}, {}, LE, 65536),
+        Link({}, {}, GE, 0, {0, 1, 2}, {}, LE, 65536 + 2)};
+    for (unsigned int i = 0; i < links.size(); i++) {
+        AnyEngine engine = makeEngine(vector<Link>{links[i]}, 3);
+        check(std::holds_alternative<Engine>(engine), "wide limit engine", i);
+        check(std::visit([](auto& engine) { return engine.count(); }, engine) == 8, "wide limit count", i);
+    }
+    AnyEngine engine = makeEngine(vector<Link>{Link({}, {}, GE, 0, {0, 1, 2}, {}, LE, 2)}, 3);
+    check(std::holds_alternative<Engine16>(engine), "narrow limit engine", 0);
+}
+
+// Links past the compact IDs are refused, leaving the engine as it was
+static void testAddRefused()
+{
+    AnyEngine engine = makeEngine(vector<Link>{Link({}, {}, GE, 0, {0, 1, 2}, {}, LE, 1)}, 3);
+    auto count = [&engine]() { return std::visit([](auto& engine) { return engine.count(); }, engine); };
+    check(std::holds_alternative<Engine16>(engine) && count() == 4, "compact engine", 0);
+    check(!addLinks(engine, {Link({}, {}, GE, 0, {0, 1}, {}, LE, 65536)}), "wide limit refused", 0);
+    check(count() == 4, "wide limit unchanged", 0);
+    const vector<Link16> links(0xFFFF, Link16({}, {}, GE, 0, {0}, {}, GE, 1));
+    check(!std::get<Engine16>(engine).addLinks(links), "link IDs refused", 0);
+    check(count() == 4, "link IDs unchanged", 0);
+    check(addLinks(engine, {Link({}, {}, GE, 0, {0}, {}, GE, 1)}) && count() == 1, "narrow link added", 0);
+}
+
+// Usage: test_engine [seed] [instances]
+//   Checks the engine against brute force on random small problems, with random
+//   heuristics, learning, restarts and thread counts; exits 1 on any failure.
+int main(int argc, char** argv)
+{
+    mt19937 rng(argc > 1 ? atoi(argv[1]) : 1);
+    const unsigned int instanceCount = argc > 2 ? atoi(argv[2]) : 300;
+    for (unsigned int instance = 0; instance < instanceCount; instance++) {
+        if (instance % 2 == 0) testInstance<Engine>(rng, instance);
+        else                   testInstance<Engine16>(rng, instance);
+        if (instance % 10 == 0) testLazy(rng, instance);
+    }
+    testWideLimits();
+    testAddRefused();
+    cout << instanceCount << " instances, " << failCount << " failures\n";
+    return failCount == 0 ? 0 : 1;
+}
@@ -0,0 +1,86 @@
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <thread>
+#include <vector>
+#include <tuple>
+#include <random>
+#include <cstdlib>
+#include "generate.h"
+using std::string;
+using std::vector;
+using std::tuple;
+using Sudoku::TSize2;
+
+// Solutions of the puzzle, up to 2, without the given at skip; all givens when skip is past them
+static Imply::TCount countWithout(Sudoku::Solver& solver, vector<tuple<TSize2,TSize2,TSize2>> puzzle, size_t skip)
+{
+    if (skip < puzzle.size()) puzzle.erase(puzzle.begin() + skip);
+    const Imply::TCount count = solver.count(puzzle, 2);
+    solver.reset();
+    return count;
+}
+
+// Each puzzle must have one solution, and lose that with any given left out
+static int check(const Sudoku::TSize size, const Sudoku::TSize8 count)
+{
+    const Sudoku::Generator generator(size, 1, 0, ~Imply::TCount(0), 1, 1000, 0);
+    Sudoku::Solver generateSolver(size), checkSolver(size);
+    std::mt19937 rng(1);
+    unsigned int failCount = 0;
+    for (Sudoku::TSize8 i = 0; i < count; i++) {
+        vector<tuple<TSize2,TSize2,TSize2>> puzzle;
+        Imply::TCount decisionCount;
+        if (!generator.generate(generateSolver, rng, puzzle, decisionCount)) {
+            std::cerr << "FAIL puzzle " << i << " given up\n";
+            failCount++;
+            continue;
+        }
+        bool minimal = true;
+        for (size_t skip = 0; skip < puzzle.size() && minimal; skip++)
+            minimal = countWithout(checkSolver, puzzle, skip) == 2;
+        if (countWithout(checkSolver, puzzle, puzzle.size()) != 1 || !minimal) {
+            std::cerr << "FAIL " << checkSolver.format(puzzle) << "\n";
+            failCount++;
+        }
+    }
+    std::cout << failCount << " failures\n";
+    return failCount == 0 ? 0 : 1;
+}
+
+// Usage: test_generate [size] [count] [threads] [output] [min decisions] [max decisions] [seed]
+//                      [attempts] [check budget]
+//   Writes up to count minimal puzzles, one per line in the format test_batch
+//   reads; '-' or no file means stdout. Only puzzles whose solving takes between
+//   min and max decisions are written, from at most attempts grids each; a grid
+//   whose checks take more than check budget decisions is given up. The report
+//   goes to stderr.
+//   test_generate check [size] [count] checks count puzzles are unique and minimal.
+int main(int argc, char** argv)
+{
+    if (argc > 1 && string(argv[1]) == "check")
+        return check(argc > 2 ? std::atoi(argv[2]) : 3, argc > 3 ? std::atoll(argv[3]) : 20);
+    const Sudoku::TSize size = argc > 1 ? std::atoi(argv[1]) : 3;
+    const Sudoku::TSize8 count = argc > 2 ? std::atoll(argv[2]) : 1000;
+    const unsigned int threadCount = argc > 3 ? std::atoi(argv[3]) : std::thread::hardware_concurrency();
+    const string outputPath = argc > 4 ? argv[4] : "-";
+    const Imply::TCount minDecisions = argc > 5 ? std::atoll(argv[5]) : 0;
+    const Imply::TCount maxDecisions = argc > 6 ? std::atoll(argv[6]) : ~Imply::TCount(0);
+    const unsigned int seed = argc > 7 ? std::atoi(argv[7]) : 1;
+    const Sudoku::TSize8 attemptLimit = argc > 8 ? std::atoll(argv[8]) : 1000;
+    const Imply::TCount checkBudget = argc > 9 ? std::atoll(argv[9]) : 10000;
+
+    std::ofstream outputFile;
+    if (outputPath != "-") outputFile.open(outputPath);
+    std::ostream& output = outputPath != "-" ? outputFile : std::cout;
+    if (!output) {
+        std::cerr << "Cannot open " << outputPath << "\n";
+        return 1;
+    }
+    std::ios::sync_with_stdio(false);
+
+    Sudoku::Generator generator(size, threadCount, minDecisions, maxDecisions, seed, attemptLimit, checkBudget);
+    Sudoku::GenerateReport report = generator.run(count, output);
+    report.print(std::cerr);
+    return 0;
+}
\ No newline at end of file
@@ -0,0 +1,153 @@
+#include <iostream>
+#include <string>
+#include <memory>
+#include <chrono>
+#include <thread>
+#include <cstdlib>
+#include <cstdio>
+#include <fstream>
+#include "load.h"
+using std::string;
+using namespace Imply;
+
+typedef std::chrono::steady_clock Clock;
+
+static bool hasExtension(const string& path, const string& extension)
+{
+    return path.size() >= extension.size() &&
+        path.compare(path.size() - extension.size(), extension.size(), extension) == 0;
+}
+
+static unsigned int failCount = 0;
+
+static void check(bool ok, const char* what)
+{
+    if (ok) return;
+    std::cerr << "FAIL " << what << "\n";
+    failCount++;
+}
+
+static string writeFile(const char* name, const char* text)
+{
+    const string path = string(P_tmpdir) + "/test_load_" + name;
+    std::ofstream(path) << text;
+    return path;
+}
+
+// Files the loader must reject without reading past them
+static void checkRejects()
+{
+    const char* rejects[][2] = {
+        {"overflow.cnf", "p cnf 2 1\n99999999999999999999 0\n"},
+        {"overflow.opb", "* #variable= 2 #constraint= 1\n+1 x1 +1 x2 >= 99999999999999999999 ;\n"},
+        // 6 * 715827883 + 1 node offsets wrap 32 bits
+        {"nodes.cnf", "p cnf 715827883 1\n1 0\n"},
+        {"nodes.opb", "+1 x1 +1 x715827883 >= 1 ;\n"},
+        {"header.opb", "* #variable= 715827883 #constraint= 1\n+1 x1 +1 x2 >= 1 ;\n"}};
+    for (const auto& reject : rejects) {
+        const string path = writeFile(reject[0], reject[1]);
+        std::shared_ptr<const Problem> problem;
+        const bool loaded = hasExtension(path, ".opb") ? Loader::loadOPB(path, problem) : Loader::loadCNF(path, problem);
+        std::remove(path.c_str());
+        check(!loaded, reject[0]);
+    }
+}
+
+// Small files with known answers: the models of each, and for OPB the literals
+// of a -1 coefficient and an equality split in two links
+static void checkAccepts()
+{
+    const struct { const char* name; const char* text; TNodeID nodeSize; TLinkID linkSize; TCount count; } accepts[] = {
+        {"sat.cnf", "c comment\np cnf 3 2\n1 -2 0\n2 0\n", 3, 2, 2},
+        {"unsat.cnf", "p cnf 1 2\n1 0\n-1 0\n", 1, 2, 0},
+        {"sat.opb", "* #variable= 4 #constraint= 2\n+1 x1 +1 x2 +1 ~x3 = 2 ;\n-1 x1 >= 0 ;\n", 4, 3, 2},
+        {"unsat.opb", "+1 x1 +1 x2 >= 3 ;\n", 2, 2, 0}};
+    for (const auto& accept : accepts) {
+        const string path = writeFile(accept.name, accept.text);
+        std::shared_ptr<const Problem> problem;
+        const bool loaded = hasExtension(path, ".opb") ? Loader::loadOPB(path, problem) : Loader::loadCNF(path, problem);
+        std::remove(path.c_str());
+        check(loaded, accept.name);
+        if (!loaded) continue;
+        Engine engine(problem);
+        check(engine.getNodeSize() == accept.nodeSize && engine.getLinkSize() == accept.linkSize &&
+            engine.count() == accept.count, accept.name);
+    }
+}
+
+// A compiled engine counts as the engine it was saved from, and rolls back
+// through its saved counter trail: with x1 and x2 FALSE, the clause forces x3
+static void checkCompiled()
+{
+    const string path = writeFile("base.cnf", "p cnf 3 1\n1 2 3 0\n");
+    const string compiledPath = string(P_tmpdir) + "/test_load_base.imply";
+    std::shared_ptr<const Problem> problem;
+    check(Loader::loadCNF(path, problem), "base.cnf");
+    std::remove(path.c_str());
+    if (problem == nullptr) return;
+    Engine engine(problem);
+    check(engine.count() == 7, "base.cnf count");
+    const Engine::Checkpoint checkpoint = engine.checkpoint();
+    engine.constrain({{0, false}, {1, false}});
+    check(Loader::saveEngine(compiledPath, engine), "save base.imply");
+    Engine loaded;
+    check(Loader::loadEngine(compiledPath, loaded), "load base.imply");
+    std::remove(compiledPath.c_str());
+    check(loaded.getNodeState(2) == TRUE && loaded.count() == 1 && loaded.count() == 1, "base.imply count");
+    loaded.rollback(checkpoint);
+    check(loaded.getNodeState(2) == MAYBE && loaded.count() == 7, "base.imply rollback");
+}
+
+// Usage: test_load [file] [threads] [learning] [compiled]
+//   Loads a DIMACS CNF file, an OPB file when the name ends in .opb or a
+//   compiled engine when it ends in .imply, and reports whether it is
+//   satisfiable. A compiled path saves the engine before solving. Without a
+//   file, checks known files, that malformed ones are rejected and that
+//   compiled engines load.
+int main(int argc, char** argv)
+{
+    if (argc < 2) {
+        checkRejects();
+        checkAccepts();
+        checkCompiled();
+        std::cout << failCount << " failures\n";
+        return failCount == 0 ? 0 : 1;
+    }
+    const string path = argv[1];
+    const unsigned int threadCount = argc > 2 ? std::atoi(argv[2]) : 1;
+    const bool learning = argc > 3 && std::atoi(argv[3]) != 0;
+    const string compiledPath = argc > 4 ? argv[4] : "";
+
+    Clock::time_point start = Clock::now();
+    Engine engine;
+    if (hasExtension(path, ".imply")) {
+        if (!Loader::loadEngine(path, engine)) {
+            std::cerr << "Cannot load " << path << "\n";
+            return 1;
+        }
+    } else {
+        std::shared_ptr<const Problem> problem;
+        if (!(hasExtension(path, ".opb") ? Loader::loadOPB(path, problem) : Loader::loadCNF(path, problem))) {
+            std::cerr << "Cannot load " << path << "\n";
+            return 1;
+        }
+        engine = Engine(problem);
+    }
+    std::cout << "Nodes: " << engine.getNodeSize() << "\n";
+    std::cout << "Links: " << engine.getLinkSize() << "\n";
+    std::cout << "Load seconds: " << std::chrono::duration<double>(Clock::now() - start).count() << "\n";
+    if (!compiledPath.empty() && !Loader::saveEngine(compiledPath, engine)) {
+        std::cerr << "Cannot save " << compiledPath << "\n";
+        return 1;
+    }
+
+    start = Clock::now();
+    if (learning) {
+        engine.setHeuristic(ACTIVITY);
+        engine.setLearning(true);
+    }
+    const bool ret = engine.backtrack(threadCount);
+    std::cout << (ret ? "SAT" : "UNSAT") << "\n";
+    std::cout << "Solve seconds: " << std::chrono::duration<double>(Clock::now() - start).count() << "\n";
+    return 0;
+}
\ No newline at end of file
@@ -1,11 +1,49 @@
 #include <iostream>
 #include <vector>
 #include <tuple>
+#include <string>
 #include "sudoku.h"
 using std::vector;
 using std::tuple;
+using std::string;
 using Sudoku::TSize2;
 
+// Puzzles that propagation leaves open, with their known solutions: two with
+// one solution, then the first with a wrong given, which has none
+static const char* LANE_CASES[][2] = {
+    {"8..........36......7..9.2...5...7.......457.....1...3...1....68..85...1..9....4..",
+     "812753649943682175675491283154237896369845721287169534521974368438526917796318452"},
+    {"1....7.9..3..2...8..96..5....53..9...1..8...26....4...3......1..4......7..7...3..",
+     "162857493534129678789643521475312986913586742628794135356478219241935867897261354"},
+    {"82.........36......7..9.2...5...7.......457.....1...3...1....68..85...1..9....4..", ""}};
+
+// Lanes must search whatever their propagation leaves open and match the answers
+static unsigned int checkLanes()
+{
+    unsigned int failCount = 0;
+    Sudoku::Solver sudoku(3);
+    vector<vector<tuple<TSize2,TSize2,TSize2>>> rcnumsVector;
+    vector<string> expected;
+    for (const auto& [puzzle, solution] : LANE_CASES) {
+        vector<tuple<TSize2,TSize2,TSize2>> rcnums;
+        sudoku.parse(puzzle, rcnums);
+        sudoku.solve(rcnums);
+        if (sudoku.format().find('.') == string::npos) {
+            std::cerr << "FAIL propagation alone solves " << puzzle << "\n";
+            failCount++;
+        }
+        sudoku.reset();
+        rcnumsVector.push_back(rcnums);
+        expected.push_back(solution);
+    }
+    vector<string> lines;
+    if (sudoku.solveLanes(rcnumsVector, lines) != 2 || lines != expected) {
+        std::cerr << "FAIL lanes\n";
+        failCount++;
+    }
+    return failCount;
+}
+
 int main(void)
 {
     Sudoku::Solver sudoku(3);
@@ -26,5 +64,7 @@ int main(void)
     bool ret = sudoku.solve(nums, true);
     std::cout << "Ret: " << ret << "\n";
     sudoku.print();
-    return 0;
+    const unsigned int failCount = checkLanes();
+    std::cout << failCount << " failures\n";
+    return failCount == 0 ? 0 : 1;
 }
\ No newline at end of file